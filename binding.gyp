@@ -4,6 +4,12 @@
       'target_name': 'soem_addon',
       'sources': [
         'src/addon.cc',
+        'src/mailbox_scheduler.cc',
+        'src/historian.cc',
+        'src/topology.cc',
+        'src/diagnostics.cc',
+        'src/iomap.cc',
+        'src/node_soem_legacy.cc',
         'external/soem/src/ec_base.c',
         'external/soem/src/ec_coe.c',
         'external/soem/src/ec_config.c',
@@ -15,7 +15,11 @@
 #endif
 
 #include "soem_wrap.hpp"
+#include <algorithm>
+#include <climits>
 #include <cstring>
+#include <memory>
+#include <thread>
 #include <vector>
 
 namespace soemnode
@@ -23,6 +27,597 @@ namespace soemnode
 
     Napi::FunctionReference constructor;
 
+    namespace
+    {
+        // exchange() status slots: WKC, expected WKC, round trip from before the
+        // send to the end of the receive (us), whole call including image copies (us).
+        constexpr size_t kExchangeStatusLength = 4;
+
+        // Default capacity of the mailbox scratch buffer used by sdoRead / SoEread
+        // when the caller does not pass an explicit maximum size.
+        constexpr size_t kDefaultTransferSize = 64 * 1024;
+
+        // How long a synchronous call on the JS thread waits for the mailbox
+        // lock before failing with EBUSY: enough for a register frame held
+        // by the diagnostics poller, far below a mailbox transfer.
+        constexpr int kMailboxLockWaitUs = 500;
+
+        // Shortest frame timeout given to a queued register access. A window
+        // that is almost used up would otherwise time out the frame before
+        // the slave can answer; the scheduler counts the resulting overrun.
+        constexpr int kMinRegisterTimeoutUs = 500;
+
+        // Initial capacity of each group IOmap. ecx_config_map_group takes no
+        // size, so mapGroup sizes the map from groupIOmapEstimate first.
+        constexpr size_t kGroupIOmapSize = 8192;
+
+        // Bytes of a group image as the historian sees it: outputs, then inputs.
+        uint32_t groupImageBytes(const ec_groupt &grp)
+        {
+            const uint8 *base = grp.outputs ? grp.outputs : grp.inputs;
+            return grp.inputs ? static_cast<uint32_t>(grp.inputs + grp.Ibytes - base) : grp.Obytes;
+        }
+
+        // Resolve a Buffer / TypedArray / DataView / ArrayBuffer argument to the
+        // bytes backing it, without copying.
+        bool viewBytes(const Napi::Value &value, uint8_t *&data, size_t &length)
+        {
+            if (value.IsTypedArray())
+            {
+                Napi::TypedArray ta = value.As<Napi::TypedArray>();
+                data = static_cast<uint8_t *>(ta.ArrayBuffer().Data()) + ta.ByteOffset();
+                length = ta.ByteLength();
+                return true;
+            }
+            if (value.IsDataView())
+            {
+                Napi::DataView dv = value.As<Napi::DataView>();
+                data = static_cast<uint8_t *>(dv.ArrayBuffer().Data()) + dv.ByteOffset();
+                length = dv.ByteLength();
+                return true;
+            }
+            if (value.IsArrayBuffer())
+            {
+                Napi::ArrayBuffer ab = value.As<Napi::ArrayBuffer>();
+                data = static_cast<uint8_t *>(ab.Data());
+                length = ab.ByteLength();
+                return true;
+            }
+            return false;
+        }
+
+        // Resolve the (target, offset) pair of the *Into readers to a writable
+        // window. Returns false if the target is not a byte view or the offset is
+        // out of range.
+        bool targetWindow(const Napi::CallbackInfo &info, size_t targetArg, uint8_t *&data, int &size)
+        {
+            size_t length = 0;
+            if (info.Length() <= targetArg || !viewBytes(info[targetArg], data, length))
+                return false;
+            size_t offset = 0;
+            if (info.Length() > targetArg + 1 && info[targetArg + 1].IsNumber())
+            {
+                int64_t o = info[targetArg + 1].As<Napi::Number>().Int64Value();
+                if (o < 0)
+                    return false;
+                offset = static_cast<size_t>(o);
+            }
+            if (offset > length)
+                return false;
+            data += offset;
+            size_t avail = length - offset;
+            size = avail > static_cast<size_t>(INT_MAX) ? INT_MAX : static_cast<int>(avail);
+            return true;
+        }
+
+        struct ODEntryInfo
+        {
+            uint8 subIndex;
+            uint16 dataType;
+            uint16 bitLength;
+            uint16 access;
+            std::string name;
+        };
+
+        struct ODObjectInfo
+        {
+            uint16 index;
+            uint16 dataType;
+            uint8 objectCode;
+            uint8 maxSub;
+            std::string name;
+            std::vector<ODEntryInfo> entries;
+        };
+
+        // Walks a slave's object dictionary with the CoE SDO information services
+        // (OD list, object description, entry description) off the JS thread.
+        // Each transaction holds the master's mailbox lock, so the scan
+        // interleaves with sdoRead and the mailbox scheduler instead of racing
+        // them, and close() waits for the scan to stop.
+        class ODScanWorker : public Napi::AsyncWorker
+        {
+        public:
+            ODScanWorker(Napi::Env env, Napi::Object owner, Master *master, uint16 slave)
+                : Napi::AsyncWorker(env, "soem:readObjectDictionary"), deferred_(Napi::Promise::Deferred::New(env)), master_(master), ctx_(master->context()), slave_(slave)
+            {
+                // Keep the owning Master alive while the scan runs.
+                owner_ = Napi::Persistent(owner);
+            }
+
+            Napi::Promise Promise() const { return deferred_.Promise(); }
+
+        protected:
+            void Execute() override
+            {
+                struct Release
+                {
+                    Master *master;
+                    ~Release() { master->endBackground(); }
+                } release{master_};
+
+                std::unique_ptr<ec_ODlistt> odlist(new ec_ODlistt());
+                std::unique_ptr<ec_OElistt> oelist(new ec_OElistt());
+                odlist->Entries = 0;
+                int ret;
+                {
+                    std::lock_guard<std::mutex> lock(master_->mailboxLock());
+                    ret = ecx_readODlist(ctx_, slave_, odlist.get());
+                }
+                if (ret <= 0)
+                {
+                    SetError("OD list read failed (slave without CoE SDO information?)");
+                    return;
+                }
+                objects_.reserve(odlist->Entries);
+                for (uint16 i = 0; i < odlist->Entries; i++)
+                {
+                    if (master_->closing())
+                    {
+                        SetError("readObjectDictionary: master closed");
+                        return;
+                    }
+                    std::lock_guard<std::mutex> lock(master_->mailboxLock());
+                    // A failed description leaves the previous object's name and
+                    // types in odlist: skip the object rather than report them.
+                    if (ecx_readODdescription(ctx_, i, odlist.get()) <= 0)
+                    {
+                        incomplete_ = true;
+                        continue;
+                    }
+                    ODObjectInfo obj;
+                    obj.index = odlist->Index[i];
+                    obj.dataType = odlist->DataType[i];
+                    obj.objectCode = odlist->ObjectCode[i];
+                    obj.maxSub = odlist->MaxSub[i];
+                    obj.name = odlist->Name[i];
+                    std::memset(oelist.get(), 0, sizeof(ec_OElistt));
+                    if (ecx_readOE(ctx_, i, odlist.get(), oelist.get()) > 0)
+                    {
+                        for (uint16 j = 0; j < oelist->Entries && j <= obj.maxSub; j++)
+                        {
+                            // Unused sub-indexes come back with a zero data type.
+                            if (oelist->DataType[j] == 0 && oelist->BitLength[j] == 0)
+                                continue;
+                            obj.entries.push_back({static_cast<uint8>(j), oelist->DataType[j], oelist->BitLength[j], oelist->ObjAccess[j], oelist->Name[j]});
+                        }
+                    }
+                    else
+                    {
+                        incomplete_ = true;
+                    }
+                    objects_.push_back(std::move(obj));
+                }
+            }
+
+            void OnOK() override
+            {
+                Napi::Env env = Env();
+                const ec_slavet &sl = ctx_->slavelist[slave_];
+                Napi::Object od = Napi::Object::New(env);
+                od.Set("vendorId", Napi::Number::New(env, sl.eep_man));
+                od.Set("productCode", Napi::Number::New(env, sl.eep_id));
+                od.Set("revision", Napi::Number::New(env, sl.eep_rev));
+                Napi::Array objects = Napi::Array::New(env, objects_.size());
+                for (size_t i = 0; i < objects_.size(); i++)
+                {
+                    const ODObjectInfo &o = objects_[i];
+                    Napi::Object obj = Napi::Object::New(env);
+                    obj.Set("index", Napi::Number::New(env, o.index));
+                    obj.Set("dataType", Napi::Number::New(env, o.dataType));
+                    obj.Set("objectCode", Napi::Number::New(env, o.objectCode));
+                    obj.Set("maxSub", Napi::Number::New(env, o.maxSub));
+                    obj.Set("name", Napi::String::New(env, o.name));
+                    Napi::Array entries = Napi::Array::New(env, o.entries.size());
+                    for (size_t j = 0; j < o.entries.size(); j++)
+                    {
+                        const ODEntryInfo &e = o.entries[j];
+                        Napi::Object entry = Napi::Object::New(env);
+                        entry.Set("subIndex", Napi::Number::New(env, e.subIndex));
+                        entry.Set("dataType", Napi::Number::New(env, e.dataType));
+                        entry.Set("bitLength", Napi::Number::New(env, e.bitLength));
+                        entry.Set("access", Napi::Number::New(env, e.access));
+                        entry.Set("name", Napi::String::New(env, e.name));
+                        entries.Set(static_cast<uint32_t>(j), entry);
+                    }
+                    obj.Set("entries", entries);
+                    objects.Set(static_cast<uint32_t>(i), obj);
+                }
+                od.Set("objects", objects);
+                if (incomplete_)
+                    od.Set("incomplete", Napi::Boolean::New(env, true));
+                deferred_.Resolve(od);
+            }
+
+            void OnError(const Napi::Error &e) override
+            {
+                deferred_.Reject(e.Value());
+            }
+
+        private:
+            Napi::Promise::Deferred deferred_;
+            Napi::ObjectReference owner_;
+            Master *master_;
+            ecx_contextt *ctx_;
+            uint16 slave_;
+            std::vector<ODObjectInfo> objects_;
+            bool incomplete_ = false;
+        };
+
+        // Hot-plug configuration off the JS thread: SII reads, PDO mapping and
+        // the state changes of the new slaves take seconds.
+        class ConfigNewSlavesWorker : public Napi::AsyncWorker
+        {
+        public:
+            ConfigNewSlavesWorker(Napi::Env env, Napi::Object owner, Master *master, uint8 group)
+                : Napi::AsyncWorker(env, "soem:configNewSlaves"), deferred_(Napi::Promise::Deferred::New(env)), master_(master), ctx_(master->context()), group_(group)
+            {
+                owner_ = Napi::Persistent(owner);
+            }
+
+            Napi::Promise Promise() const { return deferred_.Promise(); }
+
+        protected:
+            void Execute() override
+            {
+                struct Release
+                {
+                    Master *master;
+                    ~Release() { master->endBackground(); }
+                } release{master_};
+
+                // The whole hot-plug holds the context lock: the new slave
+                // entries, slavecount, the mapping and the state changes are
+                // complete before anything else reads them. Synchronous calls
+                // fail with EBUSY and queued mailbox requests wait meanwhile;
+                // the JS thread sees the new count once the promise settles.
+                std::lock_guard<std::mutex> lock(master_->mailboxLock());
+                TopologyScan scan;
+                if (!soemnode::scanTopology(ctx_, false, scan))
+                {
+                    SetError("configNewSlaves: bus scan failed");
+                    return;
+                }
+                first_ = ctx_->slavecount + 1;
+                added_ = configureAppendedSlaves(ctx_, scan, group_, err_);
+                last_ = ctx_->slavecount;
+                if (added_ < 0)
+                {
+                    SetError("configNewSlaves: " + err_);
+                    return;
+                }
+                if (added_ == 0)
+                    return;
+
+                waitState(EC_STATE_PRE_OP, "PRE-OP");
+                if (master_->closing())
+                {
+                    SetError("configNewSlaves: master closed");
+                    return;
+                }
+
+                // The new image starts after everything already mapped, so the
+                // existing LRW frames and their expected WKC are unchanged.
+                ec_groupt &grp = ctx_->grouplist[group_];
+                uint32 end = 0;
+                for (int g = 0; g < EC_MAXGROUP; g++)
+                {
+                    const ec_groupt &other = ctx_->grouplist[g];
+                    if (g != group_ && (other.Obytes || other.Ibytes))
+                        end = std::max<uint32>(end, other.logstartaddr + other.Obytes + other.Ibytes);
+                }
+                grp.logstartaddr = end;
+                bytes_ = master_->mapGroupLocked(group_);
+
+                for (int s = first_; s <= last_; s++)
+                {
+                    ctx_->slavelist[s].state = EC_STATE_SAFE_OP;
+                    ecx_writestate(ctx_, static_cast<uint16>(s));
+                }
+                waitState(EC_STATE_SAFE_OP, "SAFE-OP");
+
+                logicalStart_ = grp.logstartaddr;
+                outputsBytes_ = grp.Obytes;
+                inputsBytes_ = grp.Ibytes;
+                expectedWkc_ = grp.outputsWKC * 2 + grp.inputsWKC;
+            }
+
+            void OnOK() override
+            {
+                master_->endHotplug();
+                Napi::Env env = Env();
+                Napi::Object o = Napi::Object::New(env);
+                o.Set("added", Napi::Number::New(env, added_));
+                o.Set("group", Napi::Number::New(env, group_));
+                if (added_ > 0)
+                {
+                    o.Set("firstSlave", Napi::Number::New(env, first_));
+                    o.Set("lastSlave", Napi::Number::New(env, last_));
+                    o.Set("logicalStart", Napi::Number::New(env, logicalStart_));
+                    o.Set("ioMapBytes", Napi::Number::New(env, bytes_));
+                    o.Set("outputsBytes", Napi::Number::New(env, outputsBytes_));
+                    o.Set("inputsBytes", Napi::Number::New(env, inputsBytes_));
+                    o.Set("expectedWkc", Napi::Number::New(env, expectedWkc_));
+                }
+                if (!err_.empty())
+                    o.Set("error", Napi::String::New(env, err_));
+                deferred_.Resolve(o);
+            }
+
+            void OnError(const Napi::Error &e) override
+            {
+                master_->endHotplug();
+                deferred_.Reject(e.Value());
+            }
+
+        private:
+            // Short statechecks so close() is not held up for EC_TIMEOUTSTATE
+            // per slave; a slave that misses the state is reported in error.
+            void waitState(uint16 state, const char *name)
+            {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(EC_TIMEOUTSTATE);
+                for (int s = first_; s <= last_; s++)
+                {
+                    while (ecx_statecheck(ctx_, static_cast<uint16>(s), state, kStatePollUs) != state)
+                    {
+                        if (master_->closing() || std::chrono::steady_clock::now() >= deadline)
+                        {
+                            if (!err_.empty())
+                                err_ += "; ";
+                            err_ += "slave " + std::to_string(s) + " did not reach " + name;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            static constexpr int kStatePollUs = 50000;
+
+            Napi::Promise::Deferred deferred_;
+            Napi::ObjectReference owner_;
+            Master *master_;
+            ecx_contextt *ctx_;
+            uint8 group_;
+            int added_ = 0;
+            int first_ = 0;
+            int last_ = 0;
+            int bytes_ = 0;
+            uint32 logicalStart_ = 0;
+            uint32 outputsBytes_ = 0;
+            uint32 inputsBytes_ = 0;
+            int expectedWkc_ = 0;
+            std::string err_;
+        };
+
+        // Decodes a history directory off the JS thread: a long time range
+        // means mapping and decoding many segments.
+        class HistoryReadWorker : public Napi::AsyncWorker
+        {
+        public:
+            HistoryReadWorker(Napi::Env env, std::string dir, int64_t from, int64_t to, size_t maxRecords)
+                : Napi::AsyncWorker(env, "soem:readHistory"), deferred_(Napi::Promise::Deferred::New(env)), dir_(std::move(dir)), from_(from), to_(to), maxRecords_(maxRecords)
+            {
+            }
+
+            Napi::Promise Promise() const { return deferred_.Promise(); }
+
+        protected:
+            void Execute() override
+            {
+                std::string err;
+                if (!Historian::read(dir_, from_, to_, maxRecords_, res_, err))
+                    SetError("readHistory: " + err);
+            }
+
+            void OnOK() override
+            {
+                Napi::Env env = Env();
+                size_t n = res_.timestamps.size();
+                Napi::BigInt64Array ts = Napi::BigInt64Array::New(env, n);
+                Napi::Int32Array wkc = Napi::Int32Array::New(env, n);
+                if (n)
+                {
+                    std::memcpy(ts.Data(), res_.timestamps.data(), n * sizeof(int64_t));
+                    std::memcpy(wkc.Data(), res_.wkc.data(), n * sizeof(int32_t));
+                }
+                Napi::Object o = Napi::Object::New(env);
+                o.Set("recordSize", Napi::Number::New(env, res_.recordSize));
+                o.Set("timestamps", ts);
+                o.Set("wkc", wkc);
+                o.Set("data", Napi::Buffer<uint8_t>::Copy(env, res_.data.data(), res_.data.size()));
+                deferred_.Resolve(o);
+            }
+
+            void OnError(const Napi::Error &e) override
+            {
+                deferred_.Reject(e.Value());
+            }
+
+        private:
+            Napi::Promise::Deferred deferred_;
+            std::string dir_;
+            int64_t from_;
+            int64_t to_;
+            size_t maxRecords_;
+            Historian::Result res_;
+        };
+
+        enum class MbxKind
+        {
+            SdoRead,
+            SdoWrite,
+            SoeRead,
+            SoeWrite,
+            EepromRead,
+            EepromWrite,
+            RegisterRead,
+            RegisterWrite
+        };
+
+        // One queued acyclic request. Arguments are copied out of JS on submit,
+        // the result is turned back into a JS value on the main thread.
+        struct MailboxJob : MailboxScheduler::Job
+        {
+            explicit MailboxJob(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+
+            void run(ecx_contextt *ctx, int windowUs) override
+            {
+                int sz = 0;
+                // A register access is a single frame: keep it inside the window,
+                // but never below the time a frame needs to come back. Mailbox
+                // transfers cannot be cut short without losing the answer, so
+                // they keep their own timeout.
+                int frameTimeout = timeout;
+                if (windowUs >= 0)
+                    frameTimeout = std::min(timeout, std::max(windowUs, kMinRegisterTimeoutUs));
+                switch (kind)
+                {
+                case MbxKind::SdoRead:
+                    data.resize(length);
+                    sz = static_cast<int>(length);
+                    wkc = ecx_SDOread(ctx, slave, index, sub, ca ? TRUE : FALSE, &sz, data.data(), timeout);
+                    data.resize(wkc > 0 ? static_cast<size_t>(sz) : 0);
+                    break;
+                case MbxKind::SdoWrite:
+                    wkc = ecx_SDOwrite(ctx, slave, index, sub, ca ? TRUE : FALSE, static_cast<int>(data.size()), data.data(), timeout);
+                    break;
+                case MbxKind::SoeRead:
+                    data.resize(length);
+                    sz = static_cast<int>(length);
+                    wkc = ecx_SoEread(ctx, slave, driveNo, elementflags, index, &sz, data.data(), timeout);
+                    data.resize(wkc > 0 ? static_cast<size_t>(sz) : 0);
+                    break;
+                case MbxKind::SoeWrite:
+                    wkc = ecx_SoEwrite(ctx, slave, driveNo, elementflags, index, static_cast<int>(data.size()), data.data(), timeout);
+                    break;
+                case MbxKind::EepromRead:
+                {
+                    // ecx_readeeprom returns 0 on failure as well; the EEPROM
+                    // status register tells a real 0 from a NACK or a timeout.
+                    value = ecx_readeeprom(ctx, slave, index, timeout);
+                    uint16 estat = 0;
+                    wkc = ecx_FPRD(&ctx->port, ctx->slavelist[slave].configadr, ECT_REG_EEPSTAT, sizeof(estat), &estat, EC_TIMEOUTRET);
+                    if (etohs(estat) & (EC_ESTAT_EMASK | EC_ESTAT_BUSY))
+                        wkc = 0;
+                    break;
+                }
+                case MbxKind::EepromWrite:
+                    wkc = ecx_writeeeprom(ctx, slave, index, static_cast<uint16>(value), timeout);
+                    break;
+                case MbxKind::RegisterRead:
+                    data.resize(length);
+                    wkc = ecx_FPRD(&ctx->port, ctx->slavelist[slave].configadr, index, static_cast<uint16>(length), data.data(), frameTimeout);
+                    break;
+                case MbxKind::RegisterWrite:
+                    wkc = ecx_FPWR(&ctx->port, ctx->slavelist[slave].configadr, index, static_cast<uint16>(data.size()), data.data(), frameTimeout);
+                    break;
+                }
+            }
+
+            Napi::Value result(Napi::Env env) const
+            {
+                switch (kind)
+                {
+                case MbxKind::SdoRead:
+                case MbxKind::SoeRead:
+                case MbxKind::RegisterRead:
+                    if (wkc <= 0)
+                        return env.Null();
+                    return Napi::Buffer<uint8_t>::Copy(env, data.data(), data.size());
+                case MbxKind::EepromRead:
+                    if (wkc <= 0)
+                        return env.Null();
+                    return Napi::Number::New(env, value);
+                default:
+                    return Napi::Boolean::New(env, wkc > 0);
+                }
+            }
+
+            Napi::Promise::Deferred deferred;
+            MbxKind kind = MbxKind::SdoRead;
+            uint16 slave = 0;
+            // CoE index, SoE IDN, EEPROM word address or ESC register address.
+            uint16 index = 0;
+            uint8 sub = 0;
+            bool ca = false;
+            uint8 driveNo = 0;
+            uint8 elementflags = 0;
+            size_t length = 0;
+            uint32 value = 0;
+            int timeout = EC_TIMEOUTRXM;
+            std::vector<uint8> data;
+            int wkc = 0;
+        };
+
+        bool parseMbxKind(const std::string &type, MbxKind &kind)
+        {
+            static const struct
+            {
+                const char *name;
+                MbxKind kind;
+            } kinds[] = {
+                {"sdoRead", MbxKind::SdoRead},
+                {"sdoWrite", MbxKind::SdoWrite},
+                {"soeRead", MbxKind::SoeRead},
+                {"soeWrite", MbxKind::SoeWrite},
+                {"eepromRead", MbxKind::EepromRead},
+                {"eepromWrite", MbxKind::EepromWrite},
+                {"registerRead", MbxKind::RegisterRead},
+                {"registerWrite", MbxKind::RegisterWrite},
+            };
+            for (const auto &k : kinds)
+            {
+                if (type == k.name)
+                {
+                    kind = k.kind;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // readHistory bounds: BigInt nanoseconds or Number milliseconds since the epoch.
+        int64_t historyTime(const Napi::Value &value, int64_t fallback)
+        {
+            if (value.IsBigInt())
+            {
+                bool lossless = true;
+                return value.As<Napi::BigInt>().Int64Value(&lossless);
+            }
+            if (value.IsNumber())
+                return static_cast<int64_t>(value.As<Napi::Number>().DoubleValue() * 1e6);
+            return fallback;
+        }
+
+        uint32_t optionU32(const Napi::Object &o, const char *key, uint32_t fallback)
+        {
+            Napi::Value v = o.Get(key);
+            if (!v.IsNumber())
+                return fallback;
+            double d = v.As<Napi::Number>().DoubleValue();
+            return d > 0 ? static_cast<uint32_t>(d) : fallback;
+        }
+    }
+
     Master::Master(const Napi::CallbackInfo &info) : Napi::ObjectWrap<Master>(info)
     {
         if (info.Length() > 0 && info[0].IsString())
@@ -32,14 +627,321 @@ namespace soemnode
         std::memset(&ctx_, 0, sizeof(ctx_));
     }
 
+    Master::~Master()
+    {
+        if (diag_)
+            diag_->stop();
+        if (hist_)
+            hist_->stop();
+        if (mbx_)
+            mbx_->stop();
+        if (mbxTsfn_)
+            mbxTsfn_.Release();
+        // The environment may already be gone: the promises cannot be settled.
+        for (MailboxScheduler::Job *job : mbxOrphans_)
+            delete static_cast<MailboxJob *>(job);
+    }
+
+    void Master::ensureMailbox(Napi::Env env)
+    {
+        if (mbx_)
+            return;
+        if (!mbxTsfn_)
+        {
+            mbxTsfn_ = Napi::ThreadSafeFunction::New(env, Napi::Function::New(env, [](const Napi::CallbackInfo &) {}), "soem:mailbox", 0, 1);
+            mbxTsfn_.Unref(env);
+        }
+        // Completions are handed back to the JS thread, which settles the
+        // promise and drops the keep-alive once the queue is empty.
+        auto settle = [this](Napi::Env cbEnv, Napi::Function, MailboxJob *job)
+        {
+            // No environment: the function is being torn down with the addon.
+            if (cbEnv == nullptr)
+            {
+                delete job;
+                return;
+            }
+            settleMailboxJob(cbEnv, job);
+        };
+        mbx_.reset(new MailboxScheduler(&ctx_, mailboxLock_, [this, settle](MailboxScheduler::Job *j)
+                                        {
+                                            MailboxJob *job = static_cast<MailboxJob *>(j);
+                                            if (mbxTsfn_.BlockingCall(job, settle) != napi_ok)
+                                            {
+                                                std::lock_guard<std::mutex> lock(mbxOrphanMtx_);
+                                                mbxOrphans_.push_back(job);
+                                            }
+                                        }));
+        mbx_->configure(mbxConfig_);
+    }
+
+    void Master::settleMailboxJob(Napi::Env env, MailboxScheduler::Job *j, const char *error)
+    {
+        MailboxJob *job = static_cast<MailboxJob *>(j);
+        if (job->cancelled)
+            job->deferred.Reject(Napi::Error::New(env, "mailbox request cancelled: master closed").Value());
+        else if (error)
+            job->deferred.Reject(Napi::Error::New(env, error).Value());
+        else
+            job->deferred.Resolve(job->result(env));
+        delete job;
+        if (--mbxPending_ == 0)
+        {
+            mbxTsfn_.Unref(env);
+            Unref();
+        }
+    }
+
+    void Master::settleOrphans(Napi::Env env)
+    {
+        std::vector<MailboxScheduler::Job *> orphans;
+        {
+            std::lock_guard<std::mutex> lock(mbxOrphanMtx_);
+            orphans.swap(mbxOrphans_);
+        }
+        for (MailboxScheduler::Job *job : orphans)
+            settleMailboxJob(env, job, "mailbox request lost: completion could not be delivered");
+    }
+
+    Napi::Value Master::configureMailbox(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() >= 1 && info[0].IsObject())
+        {
+            Napi::Object o = info[0].As<Napi::Object>();
+            auto opt = [&](const char *key, uint32_t &field)
+            {
+                Napi::Value v = o.Get(key);
+                if (v.IsNumber())
+                    field = v.As<Napi::Number>().Uint32Value();
+            };
+            opt("periodUs", mbxConfig_.periodUs);
+            opt("budgetUs", mbxConfig_.budgetUs);
+            opt("maxPerCycle", mbxConfig_.maxPerCycle);
+            opt("guardUs", mbxConfig_.guardUs);
+            opt("idleAfterUs", mbxConfig_.idleAfterUs);
+            if (mbx_)
+                mbx_->configure(mbxConfig_);
+        }
+        return env.Undefined();
+    }
+
+    Napi::Value Master::mailboxSubmit(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        settleOrphans(env);
+        Napi::Promise::Deferred invalid = Napi::Promise::Deferred::New(env);
+        MbxKind kind;
+        if (info.Length() < 1 || !info[0].IsObject() || !opened_)
+        {
+            invalid.Reject(Napi::Error::New(env, "mailboxSubmit: invalid request or master not initialized").Value());
+            return invalid.Promise();
+        }
+        Napi::Object req = info[0].As<Napi::Object>();
+        Napi::Value type = req.Get("type");
+        if (!type.IsString() || !parseMbxKind(type.As<Napi::String>().Utf8Value(), kind))
+        {
+            invalid.Reject(Napi::TypeError::New(env, "mailboxSubmit: unknown request type").Value());
+            return invalid.Promise();
+        }
+        auto num = [&](const char *key, double def)
+        {
+            Napi::Value v = req.Get(key);
+            return v.IsNumber() ? v.As<Napi::Number>().DoubleValue() : def;
+        };
+        uint16 slave = static_cast<uint16>(num("slave", 0));
+        if (slave < 1 || slave > slaveCount_)
+        {
+            invalid.Reject(Napi::RangeError::New(env, "mailboxSubmit: invalid slave").Value());
+            return invalid.Promise();
+        }
+
+        std::unique_ptr<MailboxJob> job(new MailboxJob(env));
+        job->kind = kind;
+        job->slave = slave;
+        int prio = static_cast<int>(num("priority", MailboxScheduler::PRIO_NORMAL));
+        job->priority = static_cast<MailboxScheduler::Priority>(prio < 0 ? 0 : (prio >= MailboxScheduler::PRIO_COUNT ? MailboxScheduler::PRIO_COUNT - 1 : prio));
+        bool isRegister = (kind == MbxKind::RegisterRead || kind == MbxKind::RegisterWrite);
+        bool isEeprom = (kind == MbxKind::EepromRead || kind == MbxKind::EepromWrite);
+        job->timeout = static_cast<int>(num("timeout", (isRegister || isEeprom) ? EC_TIMEOUTRET : EC_TIMEOUTRXM));
+        switch (kind)
+        {
+        case MbxKind::SdoRead:
+        case MbxKind::SdoWrite:
+            job->index = static_cast<uint16>(num("index", 0));
+            job->sub = static_cast<uint8>(num("subIndex", 0));
+            job->ca = req.Get("completeAccess").IsBoolean() && req.Get("completeAccess").As<Napi::Boolean>().Value();
+            break;
+        case MbxKind::SoeRead:
+        case MbxKind::SoeWrite:
+            job->index = static_cast<uint16>(num("idn", 0));
+            job->driveNo = static_cast<uint8>(num("driveNo", 0));
+            job->elementflags = static_cast<uint8>(num("elementFlags", 0));
+            break;
+        default:
+            job->index = static_cast<uint16>(num("address", 0));
+            job->value = static_cast<uint32>(num("value", 0));
+            break;
+        }
+        if (kind == MbxKind::RegisterRead)
+            job->length = static_cast<size_t>(num("length", 0)) & 0xFFFF;
+        else
+            job->length = static_cast<size_t>(num("maxSize", static_cast<double>(kDefaultTransferSize)));
+        if (kind == MbxKind::SdoWrite || kind == MbxKind::SoeWrite || kind == MbxKind::RegisterWrite)
+        {
+            uint8_t *data = nullptr;
+            size_t length = 0;
+            if (!viewBytes(req.Get("data"), data, length))
+            {
+                invalid.Reject(Napi::TypeError::New(env, "mailboxSubmit: data must be a Buffer or TypedArray").Value());
+                return invalid.Promise();
+            }
+            job->data.assign(data, data + length);
+        }
+
+        ensureMailbox(env);
+        Napi::Promise promise = job->deferred.Promise();
+        if (mbxPending_++ == 0)
+        {
+            // Keep the master and the event loop alive until the queue drains.
+            Ref();
+            mbxTsfn_.Ref(env);
+        }
+        mbx_->submit(std::move(job));
+        return promise;
+    }
+
+    Napi::Value Master::mailboxStatus(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        settleOrphans(env);
+        MailboxScheduler::Stats st;
+        if (mbx_)
+            st = mbx_->stats();
+        Napi::Object o = Napi::Object::New(env);
+        Napi::Array queued = Napi::Array::New(env, MailboxScheduler::PRIO_COUNT);
+        Napi::Array served = Napi::Array::New(env, MailboxScheduler::PRIO_COUNT);
+        for (uint32_t p = 0; p < MailboxScheduler::PRIO_COUNT; p++)
+        {
+            queued.Set(p, Napi::Number::New(env, static_cast<double>(st.queued[p])));
+            served.Set(p, Napi::Number::New(env, static_cast<double>(st.served[p])));
+        }
+        o.Set("queued", queued);
+        o.Set("served", served);
+        o.Set("cycles", Napi::Number::New(env, static_cast<double>(st.cycles)));
+        o.Set("skippedCycles", Napi::Number::New(env, static_cast<double>(st.skippedCycles)));
+        o.Set("overruns", Napi::Number::New(env, static_cast<double>(st.overruns)));
+        o.Set("maxOverrunUs", Napi::Number::New(env, st.maxOverrunUs));
+        return o;
+    }
+
+    uint8 *Master::scratch(size_t size, std::vector<uint8> &oversize)
+    {
+        if (size > kDefaultTransferSize)
+        {
+            oversize.resize(size);
+            return oversize.data();
+        }
+        if (mbxbuf_.size() < size)
+            mbxbuf_.resize(size);
+        return mbxbuf_.data();
+    }
+
+    uint8 *Master::groupIOmap(uint8 group)
+    {
+        return groupIOmapBuffer(group)->data();
+    }
+
+    std::shared_ptr<std::vector<uint8>> Master::groupIOmapBuffer(uint8 group)
+    {
+        std::shared_ptr<std::vector<uint8>> &map = iomap_[group];
+        if (!map)
+            map = std::make_shared<std::vector<uint8>>(kGroupIOmapSize, 0);
+        return map;
+    }
+
+    int Master::mapGroup(uint8 group)
+    {
+        // Mapping reads the PDO assignment of CoE slaves over the mailbox.
+        std::lock_guard<std::mutex> lock(mailboxLock_);
+        return mapGroupLocked(group);
+    }
+
+    int Master::mapGroupLocked(uint8 group)
+    {
+        // Size the map before SOEM lays the group out in it. The old buffer
+        // stays alive for as long as a view still holds it.
+        size_t need = groupIOmapEstimate(&ctx_, group);
+        if (need > groupIOmapBuffer(group)->size())
+            iomap_[group] = std::make_shared<std::vector<uint8>>(need, 0);
+        uint8 *base = iomap_[group]->data();
+        int bytes = ecx_config_map_group(&ctx_, base, group);
+        mapGeneration_[group]++;
+        if (bytes <= 0 || static_cast<size_t>(bytes) <= iomap_[group]->size())
+            return bytes;
+
+        // A PDO assignment changed over CoE can outgrow the estimate. The
+        // output/input mapping steps of ecx_config_map_group (ec_config.c)
+        // only store base + offset in the group and slave pointers and never
+        // touch the map, and nothing has been exchanged yet: move the layout
+        // to a map that fits.
+        auto grown = std::make_shared<std::vector<uint8>>(static_cast<size_t>(bytes), 0);
+        rebaseGroupIOmap(&ctx_, group, base, static_cast<size_t>(bytes), grown->data());
+        iomap_[group] = grown;
+        return bytes;
+    }
+
+    bool Master::lockMailbox(Napi::Env env, std::unique_lock<std::mutex> &lock, const char *what)
+    {
+        // The JS thread also drives exchange(), so it never waits behind a
+        // mailbox transfer (up to EC_TIMEOUTRXM). Short holds, such as one
+        // register frame of the diagnostics poller, are waited out.
+        lock = std::unique_lock<std::mutex>(mailboxLock_, std::defer_lock);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(kMailboxLockWaitUs);
+        while (!lock.try_lock())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                Napi::Error e = Napi::Error::New(env, std::string(what) + ": mailbox busy, a scheduled or background transfer is in progress");
+                e.Set("code", Napi::String::New(env, "EBUSY"));
+                e.ThrowAsJavaScriptException();
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    bool Master::beginBackground()
+    {
+        std::lock_guard<std::mutex> lock(bgMtx_);
+        if (!opened_ || closing_)
+            return false;
+        bgActive_++;
+        return true;
+    }
+
+    void Master::endBackground()
+    {
+        std::lock_guard<std::mutex> lock(bgMtx_);
+        if (--bgActive_ == 0)
+            bgCv_.notify_all();
+    }
+
     Napi::Value Master::init(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
+        open();
+        return Napi::Boolean::New(env, opened_);
+    }
+
+    int Master::open()
+    {
         if (opened_)
-            return Napi::Boolean::New(env, true);
+            return 1;
         int ret = ecx_init(&ctx_, ifname_.c_str());
         opened_ = (ret != 0);
-        return Napi::Boolean::New(env, opened_);
+        return ret;
     }
 
     Napi::Value Master::configInit(const Napi::CallbackInfo &info)
@@ -47,8 +949,55 @@ namespace soemnode
         Napi::Env env = info.Env();
         if (!opened_)
             return Napi::Number::New(env, 0);
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "configInit"))
+            return env.Undefined();
+        return Napi::Number::New(env, configInitLocked());
+    }
+
+    int Master::configInitLocked()
+    {
+        if (!opened_)
+            return 0;
         int slaves = ecx_config_init(&ctx_);
-        return Napi::Number::New(env, slaves);
+        slaveCount_ = ctx_.slavecount;
+        return slaves;
+    }
+
+    void Master::endHotplug()
+    {
+        // The worker has finished with the context: publish what it added.
+        slaveCount_ = ctx_.slavecount;
+        hotplugGroup_ = 0;
+    }
+
+    int Master::configDCLocked()
+    {
+        if (!opened_)
+            return 0;
+        return ecx_configdc(&ctx_);
+    }
+
+    int Master::writeStateLocked(uint16 slave, uint16 state)
+    {
+        if (!opened_ || slave > ctx_.slavecount)
+            return 0;
+        ctx_.slavelist[slave].state = state;
+        return ecx_writestate(&ctx_, slave);
+    }
+
+    int Master::readStateLocked()
+    {
+        if (!opened_)
+            return 0;
+        return ecx_readstate(&ctx_);
+    }
+
+    int Master::stateCheckLocked(uint16 slave, uint16 state, int timeout)
+    {
+        if (!opened_ || slave > ctx_.slavecount)
+            return 0;
+        return ecx_statecheck(&ctx_, slave, state, timeout);
     }
 
     Napi::Value Master::configMapPDO(const Napi::CallbackInfo &info)
@@ -56,10 +1005,14 @@ namespace soemnode
         Napi::Env env = info.Env();
         if (!opened_)
             return env.Undefined();
-        static uint8 IOmap[4096];
         // Use the group-based map call in current SOEM API. Use group 0.
-        ecx_config_map_group(&ctx_, IOmap, 0);
-        ecx_configdc(&ctx_);
+        {
+            std::unique_lock<std::mutex> lock;
+            if (!lockMailbox(env, lock, "configMapPDO"))
+                return env.Undefined();
+            mapGroupLocked(0);
+            configDCLocked();
+        }
         return env.Undefined();
     }
 
@@ -70,8 +1023,12 @@ namespace soemnode
 
     Napi::Value Master::readState(const Napi::CallbackInfo &info)
     {
-        ecx_readstate(&ctx_);
-        return Napi::Number::New(info.Env(), ctx_.slavelist[0].state);
+        Napi::Env env = info.Env();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "readState"))
+            return env.Undefined();
+        readStateLocked();
+        return Napi::Number::New(env, ctx_.slavelist[0].state);
     }
 
     Napi::Value Master::sdoRead(const Napi::CallbackInfo &info)
@@ -85,14 +1042,49 @@ namespace soemnode
         bool CA = false;
         if (info.Length() >= 4 && info[3].IsBoolean())
             CA = info[3].As<Napi::Boolean>().Value();
-        uint8 buf[512];
-        int sz = sizeof(buf);
+        size_t maxSize = kDefaultTransferSize;
+        if (info.Length() >= 5 && info[4].IsNumber())
+            maxSize = info[4].As<Napi::Number>().Uint32Value();
+        if (maxSize > static_cast<size_t>(INT_MAX))
+            maxSize = INT_MAX;
+        // ecx_SDOread falls back to segmented upload on its own when the object
+        // does not fit in one mailbox; it only needs a large enough container.
+        std::vector<uint8> oversize;
+        uint8 *buf = scratch(maxSize, oversize);
+        int sz = static_cast<int>(maxSize);
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "sdoRead"))
+            return env.Undefined();
         int wkc = ecx_SDOread(&ctx_, slave, index, sub, CA ? TRUE : FALSE, &sz, buf, EC_TIMEOUTRXM);
         if (wkc <= 0)
             return env.Null();
         return Napi::Buffer<uint8_t>::Copy(env, buf, sz);
     }
 
+    Napi::Value Master::sdoReadInto(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 4)
+            return Napi::Number::New(env, -1);
+        uint16 slave = static_cast<uint16>(info[0].As<Napi::Number>().Uint32Value());
+        uint16 index = static_cast<uint16>(info[1].As<Napi::Number>().Uint32Value());
+        uint8 sub = static_cast<uint8>(info[2].As<Napi::Number>().Uint32Value());
+        uint8_t *dst = nullptr;
+        int sz = 0;
+        if (!targetWindow(info, 3, dst, sz))
+            return Napi::Number::New(env, -1);
+        bool CA = false;
+        if (info.Length() >= 6 && info[5].IsBoolean())
+            CA = info[5].As<Napi::Boolean>().Value();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "sdoReadInto"))
+            return env.Undefined();
+        int wkc = ecx_SDOread(&ctx_, slave, index, sub, CA ? TRUE : FALSE, &sz, dst, EC_TIMEOUTRXM);
+        if (wkc <= 0)
+            return Napi::Number::New(env, -1);
+        return Napi::Number::New(env, sz);
+    }
+
     Napi::Value Master::sdoWrite(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
@@ -106,6 +1098,9 @@ namespace soemnode
         bool CA = false;
         if (info.Length() >= 5 && info[4].IsBoolean())
             CA = info[4].As<Napi::Boolean>().Value();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "sdoWrite"))
+            return env.Undefined();
         int wkc = ecx_SDOwrite(&ctx_, slave, index, sub, CA ? TRUE : FALSE, sz, data.Data(), EC_TIMEOUTRXM);
         return Napi::Boolean::New(env, wkc > 0);
     }
@@ -117,9 +1112,10 @@ namespace soemnode
             return Napi::Number::New(env, 0);
         uint16 slave = static_cast<uint16>(info[0].As<Napi::Number>().Uint32Value());
         uint16 req = static_cast<uint16>(info[1].As<Napi::Number>().Uint32Value());
-        ctx_.slavelist[slave].state = req;
-        int ret = ecx_writestate(&ctx_, slave);
-        return Napi::Number::New(env, ret);
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "writeState"))
+            return env.Undefined();
+        return Napi::Number::New(env, writeStateLocked(slave, req));
     }
 
     Napi::Value Master::stateCheck(const Napi::CallbackInfo &info)
@@ -132,8 +1128,10 @@ namespace soemnode
         int timeout = EC_TIMEOUTRET;
         if (info.Length() >= 3 && info[2].IsNumber())
             timeout = info[2].As<Napi::Number>().Int32Value();
-        uint16 ret = ecx_statecheck(&ctx_, slave, req, timeout);
-        return Napi::Number::New(env, ret);
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "stateCheck"))
+            return env.Undefined();
+        return Napi::Number::New(env, stateCheckLocked(slave, req, timeout));
     }
 
     Napi::Value Master::reconfigSlave(const Napi::CallbackInfo &info)
@@ -145,6 +1143,9 @@ namespace soemnode
         int timeout = EC_TIMEOUTRET3;
         if (info.Length() >= 2 && info[1].IsNumber())
             timeout = info[1].As<Napi::Number>().Int32Value();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "reconfigSlave"))
+            return env.Undefined();
         int ret = ecx_reconfig_slave(&ctx_, slave, timeout);
         return Napi::Number::New(env, ret);
     }
@@ -158,6 +1159,9 @@ namespace soemnode
         int timeout = EC_TIMEOUTRET3;
         if (info.Length() >= 2 && info[1].IsNumber())
             timeout = info[1].As<Napi::Number>().Int32Value();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "recoverSlave"))
+            return env.Undefined();
         int ret = ecx_recover_slave(&ctx_, slave, timeout);
         return Napi::Number::New(env, ret);
     }
@@ -168,6 +1172,9 @@ namespace soemnode
         if (info.Length() < 1)
             return Napi::Number::New(env, 0);
         uint16 slave = static_cast<uint16>(info[0].As<Napi::Number>().Uint32Value());
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "slaveMbxCyclic"))
+            return env.Undefined();
         int ret = ecx_slavembxcyclic(&ctx_, slave);
         return Napi::Number::New(env, ret);
     }
@@ -175,13 +1182,22 @@ namespace soemnode
     Napi::Value Master::configDC(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
-        int ok = ecx_configdc(&ctx_);
-        return Napi::Boolean::New(env, ok != 0);
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "configDC"))
+            return env.Undefined();
+        return Napi::Boolean::New(env, configDCLocked() != 0);
     }
 
     Napi::Value Master::getSlaves(const Napi::CallbackInfo &info)
     {
-        Napi::Env env = info.Env();
+        return slaveList(info.Env(), "ALstatuscode");
+    }
+
+    Napi::Value Master::slaveList(Napi::Env env, const char *statusKey)
+    {
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "getSlaves"))
+            return env.Undefined();
         Napi::Array arr = Napi::Array::New(env);
         int i = 1;
         while (i <= ctx_.slavecount)
@@ -189,7 +1205,7 @@ namespace soemnode
             Napi::Object s = Napi::Object::New(env);
             s.Set("name", Napi::String::New(env, ctx_.slavelist[i].name ? ctx_.slavelist[i].name : ""));
             s.Set("state", Napi::Number::New(env, ctx_.slavelist[i].state));
-            s.Set("ALstatuscode", Napi::Number::New(env, ctx_.slavelist[i].ALstatuscode));
+            s.Set(statusKey, Napi::Number::New(env, ctx_.slavelist[i].ALstatuscode));
             s.Set("configadr", Napi::Number::New(env, ctx_.slavelist[i].configadr));
             s.Set("aliasadr", Napi::Number::New(env, ctx_.slavelist[i].aliasadr));
             uint32 numbytes = ctx_.slavelist[i].Obytes;
@@ -215,6 +1231,152 @@ namespace soemnode
         return arr;
     }
 
+    Napi::Value Master::scanTopology(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (!opened_)
+            return env.Null();
+        // Identifying new slaves writes their EEPROM interface registers, so
+        // it is opt-in.
+        bool identify = false;
+        if (info.Length() >= 1 && info[0].IsObject())
+        {
+            Napi::Value v = info[0].As<Napi::Object>().Get("identify");
+            if (v.IsBoolean())
+                identify = v.As<Napi::Boolean>().Value();
+        }
+        TopologyScan scan;
+        bool ok;
+        int configured;
+        {
+            std::unique_lock<std::mutex> lock;
+            if (!lockMailbox(env, lock, "scanTopology"))
+                return env.Undefined();
+            ok = soemnode::scanTopology(&ctx_, identify, scan);
+            configured = ctx_.slavecount;
+        }
+        if (!ok)
+            return env.Null();
+
+        Napi::Array slaves = Napi::Array::New(env, scan.entries.size());
+        Napi::Array added = Napi::Array::New(env);
+        uint32_t i = 0;
+        for (const TopologyEntry &e : scan.entries)
+        {
+            Napi::Object s = Napi::Object::New(env);
+            s.Set("position", Napi::Number::New(env, e.position));
+            s.Set("slave", Napi::Number::New(env, e.slave));
+            s.Set("configadr", Napi::Number::New(env, e.configadr));
+            s.Set("aliasadr", Napi::Number::New(env, e.aliasadr));
+            if (e.identified)
+            {
+                s.Set("vendorId", Napi::Number::New(env, e.vendorId));
+                s.Set("productCode", Napi::Number::New(env, e.productCode));
+                s.Set("revision", Napi::Number::New(env, e.revision));
+            }
+            s.Set("state", Napi::Number::New(env, e.alStatus & 0x1F));
+            s.Set("ALstatuscode", Napi::Number::New(env, e.alStatusCode));
+            s.Set("dlStatus", Napi::Number::New(env, e.dlStatus));
+            s.Set("linkPorts", Napi::Number::New(env, (e.dlStatus >> 4) & 0x0F));
+            s.Set("openPorts", Napi::Number::New(env, topologyOpenPorts(e.dlStatus)));
+            slaves.Set(i++, s);
+            if (!e.slave)
+                added.Set(added.Length(), Napi::Number::New(env, e.position));
+        }
+        Napi::Array removed = Napi::Array::New(env, scan.removed.size());
+        for (size_t r = 0; r < scan.removed.size(); r++)
+            removed.Set(static_cast<uint32_t>(r), Napi::Number::New(env, scan.removed[r]));
+
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("slaveCount", Napi::Number::New(env, scan.busCount));
+        o.Set("configuredCount", Napi::Number::New(env, configured));
+        o.Set("slaves", slaves);
+        o.Set("added", added);
+        o.Set("removed", removed);
+        return o;
+    }
+
+    Napi::Value Master::configNewSlaves(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        Napi::Promise::Deferred d = Napi::Promise::Deferred::New(env);
+        int group = 1;
+        if (info.Length() >= 1 && info[0].IsNumber())
+            group = info[0].As<Napi::Number>().Int32Value();
+        // Group 0 means "every slave" to ecx_config_map_group, so new slaves
+        // always get a group of their own.
+        if (group < 1 || group >= EC_MAXGROUP)
+        {
+            d.Reject(Napi::RangeError::New(env, "configNewSlaves: group must be between 1 and EC_MAXGROUP - 1").Value());
+            return d.Promise();
+        }
+        if (!opened_)
+        {
+            d.Reject(Napi::Error::New(env, "configNewSlaves: master not initialized").Value());
+            return d.Promise();
+        }
+        const ec_groupt &grp = ctx_.grouplist[group];
+        if (grp.Obytes || grp.Ibytes)
+        {
+            d.Reject(Napi::Error::New(env, "configNewSlaves: group " + std::to_string(group) + " is already mapped").Value());
+            return d.Promise();
+        }
+        if (hotplugGroup_)
+        {
+            d.Reject(Napi::Error::New(env, "configNewSlaves: already in progress").Value());
+            return d.Promise();
+        }
+        if (!beginBackground())
+        {
+            d.Reject(Napi::Error::New(env, "configNewSlaves: master closing").Value());
+            return d.Promise();
+        }
+        hotplugGroup_ = static_cast<uint8>(group);
+        ConfigNewSlavesWorker *worker = new ConfigNewSlavesWorker(env, info.This().As<Napi::Object>(), this, static_cast<uint8>(group));
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
+    }
+
+    Napi::Value Master::slaveIdentity(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1)
+            return env.Null();
+        uint16 slave = static_cast<uint16>(info[0].As<Napi::Number>().Uint32Value());
+        if (slave < 1 || slave > slaveCount_)
+            return env.Null();
+        Napi::Object id = Napi::Object::New(env);
+        id.Set("vendorId", Napi::Number::New(env, ctx_.slavelist[slave].eep_man));
+        id.Set("productCode", Napi::Number::New(env, ctx_.slavelist[slave].eep_id));
+        id.Set("revision", Napi::Number::New(env, ctx_.slavelist[slave].eep_rev));
+        return id;
+    }
+
+    Napi::Value Master::readObjectDictionary(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        uint16 slave = 0;
+        if (info.Length() >= 1 && info[0].IsNumber())
+            slave = static_cast<uint16>(info[0].As<Napi::Number>().Uint32Value());
+        if (!opened_ || slave < 1 || slave > slaveCount_)
+        {
+            Napi::Promise::Deferred d = Napi::Promise::Deferred::New(env);
+            d.Reject(Napi::Error::New(env, "readObjectDictionary: invalid slave or master not initialized").Value());
+            return d.Promise();
+        }
+        if (!beginBackground())
+        {
+            Napi::Promise::Deferred d = Napi::Promise::Deferred::New(env);
+            d.Reject(Napi::Error::New(env, "readObjectDictionary: master closing").Value());
+            return d.Promise();
+        }
+        ODScanWorker *worker = new ODScanWorker(env, info.This().As<Napi::Object>(), this, slave);
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
+    }
+
     Napi::Value Master::initRedundant(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
@@ -222,13 +1384,128 @@ namespace soemnode
             return Napi::Boolean::New(env, false);
         std::string if1 = info[0].As<Napi::String>().Utf8Value();
         std::string if2 = info[1].As<Napi::String>().Utf8Value();
-        ecx_redportt redport;
-        std::memset(&redport, 0, sizeof(redport));
-        int ret = ecx_init_redundant(&ctx_, &redport, if1.c_str(), const_cast<char *>(if2.c_str()));
+        if (opened_)
+            return Napi::Boolean::New(env, redundant_);
+        std::memset(&redport_, 0, sizeof(redport_));
+        red_ = RedundancyStats();
+        redIdxCount_ = 0;
+        int ret = ecx_init_redundant(&ctx_, &redport_, if1.c_str(), const_cast<char *>(if2.c_str()));
         opened_ = (ret != 0);
+        redundant_ = opened_;
+        red_.lastComplete = std::chrono::steady_clock::now();
         return Napi::Boolean::New(env, opened_);
     }
 
+    void Master::redundancyArm()
+    {
+        if (!redundant_)
+            return;
+        // rxsa only gets written when a frame arrives, so stale values must be
+        // cleared for an empty socket to read as "nothing received". This has
+        // to happen before the send: once the frame is out, a worker thread
+        // reading the socket may already store its source MAC. Only free
+        // buffers are touched; the others are in flight for another thread.
+        for (int idx = 0; idx < EC_MAXBUF; idx++)
+        {
+            redFree_[idx] = ctx_.port.rxbufstat[idx] == EC_BUF_EMPTY && redport_.rxbufstat[idx] == EC_BUF_EMPTY;
+            if (redFree_[idx])
+            {
+                ctx_.port.rxsa[idx] = 0;
+                redport_.rxsa[idx] = 0;
+            }
+        }
+    }
+
+    void Master::redundancySent()
+    {
+        if (!redundant_)
+            return;
+        int pushed = ctx_.idxstack.pushed;
+        for (int i = redIdxCount_; i < pushed && i < EC_MAXBUF; i++)
+        {
+            uint8 idx = ctx_.idxstack.idx[i];
+            redIdx_[i] = idx;
+            // A buffer that was busy at arm time and freed before the send
+            // picked it still holds another frame's source MAC: skip it.
+            redIdxArmed_[i] = redFree_[idx];
+        }
+        redIdxCount_ = pushed < EC_MAXBUF ? pushed : EC_MAXBUF;
+    }
+
+    void Master::redundancyTrack(int wkc, uint8 group)
+    {
+        if (!redundant_)
+            return;
+        auto now = std::chrono::steady_clock::now();
+        bool broken = false;
+        for (int i = 0; i < redIdxCount_; i++)
+        {
+            if (!redIdxArmed_[i])
+                continue;
+            uint8 idx = redIdx_[i];
+            int prim = ctx_.port.rxsa[idx];
+            int sec = redport_.rxsa[idx];
+            if (prim != 0)
+                red_.primaryFrames++;
+            if (sec != 0)
+                red_.secondaryFrames++;
+            if (prim == 0 && sec == 0)
+                red_.lostFrames++;
+            // Closed ring: the primary frame comes back on the secondary socket
+            // and the secondary dummy frame on the primary one. Anything else
+            // means SOEM had to take the redundant path.
+            else if (!(prim == secMAC[1] && sec == priMAC[1]))
+                broken = true;
+        }
+        redIdxCount_ = 0;
+        red_.cycles++;
+
+        if (broken && !red_.lineBreak)
+            red_.lineBreaks++;
+        red_.lineBreak = broken;
+
+        const ec_groupt &grp = ctx_.grouplist[group];
+        int expected = grp.outputsWKC * 2 + grp.inputsWKC;
+        if (wkc >= expected)
+        {
+            if (red_.failoverPending)
+            {
+                red_.lastFailoverCycles = red_.pendingCycles;
+                red_.lastFailoverUs = std::chrono::duration<double, std::micro>(now - red_.lastComplete).count();
+                if (red_.lastFailoverCycles > red_.maxFailoverCycles)
+                    red_.maxFailoverCycles = red_.lastFailoverCycles;
+                if (red_.lastFailoverUs > red_.maxFailoverUs)
+                    red_.maxFailoverUs = red_.lastFailoverUs;
+                red_.failoverPending = false;
+                red_.pendingCycles = 0;
+            }
+            red_.lastComplete = now;
+        }
+        else
+        {
+            red_.failoverPending = true;
+            red_.pendingCycles++;
+        }
+    }
+
+    Napi::Value Master::redundancyStatus(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("enabled", Napi::Boolean::New(env, redundant_));
+        o.Set("lineBreak", Napi::Boolean::New(env, red_.lineBreak));
+        o.Set("lineBreaks", Napi::Number::New(env, red_.lineBreaks));
+        o.Set("cycles", Napi::Number::New(env, static_cast<double>(red_.cycles)));
+        o.Set("primaryFrames", Napi::Number::New(env, static_cast<double>(red_.primaryFrames)));
+        o.Set("secondaryFrames", Napi::Number::New(env, static_cast<double>(red_.secondaryFrames)));
+        o.Set("lostFrames", Napi::Number::New(env, static_cast<double>(red_.lostFrames)));
+        o.Set("lastFailoverCycles", Napi::Number::New(env, red_.lastFailoverCycles));
+        o.Set("maxFailoverCycles", Napi::Number::New(env, red_.maxFailoverCycles));
+        o.Set("lastFailoverUs", Napi::Number::New(env, red_.lastFailoverUs));
+        o.Set("maxFailoverUs", Napi::Number::New(env, red_.maxFailoverUs));
+        return o;
+    }
+
     Napi::Value Master::configMapGroup(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
@@ -237,11 +1514,15 @@ namespace soemnode
         int group = 0;
         if (info.Length() >= 1 && info[0].IsNumber())
             group = info[0].As<Napi::Number>().Int32Value();
-        static uint8 IOmap[8192];
-        int bytes = ecx_config_map_group(&ctx_, IOmap, static_cast<uint8>(group));
+        if (group < 0 || group >= EC_MAXGROUP)
+            return env.Null();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "configMapGroup"))
+            return env.Undefined();
+        int bytes = mapGroupLocked(static_cast<uint8>(group));
         if (bytes <= 0)
             return env.Null();
-        return Napi::Buffer<uint8_t>::Copy(env, IOmap, bytes);
+        return Napi::Buffer<uint8_t>::Copy(env, groupIOmap(static_cast<uint8>(group)), bytes);
     }
 
     Napi::Value Master::sendProcessdataGroup(const Napi::CallbackInfo &info)
@@ -250,8 +1531,7 @@ namespace soemnode
         int group = 0;
         if (info.Length() >= 1 && info[0].IsNumber())
             group = info[0].As<Napi::Number>().Int32Value();
-        int ret = ecx_send_processdata_group(&ctx_, static_cast<uint8>(group));
-        return Napi::Number::New(env, ret);
+        return Napi::Number::New(env, sendGroup(static_cast<uint8>(group)));
     }
 
     Napi::Value Master::receiveProcessdataGroup(const Napi::CallbackInfo &info)
@@ -263,8 +1543,261 @@ namespace soemnode
             group = info[0].As<Napi::Number>().Int32Value();
         if (info.Length() >= 2 && info[1].IsNumber())
             timeout = info[1].As<Napi::Number>().Int32Value();
-        int ret = ecx_receive_processdata_group(&ctx_, static_cast<uint8>(group), timeout);
-        return Napi::Number::New(env, ret);
+        return Napi::Number::New(env, receiveGroup(static_cast<uint8>(group), timeout));
+    }
+
+    Napi::Value Master::exchange(const Napi::CallbackInfo &info)
+    {
+        // Hot path for JS-driven cycles: no objects are created here, results
+        // go to the caller's preallocated Int32Array.
+        // Argument errors throw: returning quietly would leave the previous
+        // cycle's WKC in status and hide the failure from the caller.
+        Napi::Env env = info.Env();
+        if (info.Length() < 3 || !info[2].IsTypedArray())
+        {
+            Napi::TypeError::New(env, "exchange: status must be an Int32Array").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        Napi::TypedArray st = info[2].As<Napi::TypedArray>();
+        if (st.TypedArrayType() != napi_int32_array || st.ElementLength() < kExchangeStatusLength)
+        {
+            Napi::TypeError::New(env, "exchange: status must be an Int32Array of at least 4 elements").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        int32_t *status = reinterpret_cast<int32_t *>(static_cast<uint8_t *>(st.ArrayBuffer().Data()) + st.ByteOffset());
+        int group = 0;
+        int timeout = EC_TIMEOUTRET;
+        if (info.Length() >= 4 && info[3].IsNumber())
+            group = info[3].As<Napi::Number>().Int32Value();
+        if (info.Length() >= 5 && info[4].IsNumber())
+            timeout = info[4].As<Napi::Number>().Int32Value();
+        if (group < 0 || group >= EC_MAXGROUP)
+        {
+            status[0] = -1;
+            Napi::RangeError::New(env, "exchange: group out of range").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (hotplugging(static_cast<uint8>(group)))
+        {
+            status[0] = -1;
+            Napi::Error e = Napi::Error::New(env, "exchange: group " + std::to_string(group) + " is being configured by configNewSlaves");
+            e.Set("code", Napi::String::New(env, "EBUSY"));
+            e.ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        // null / undefined skip the copy; anything else must be a byte view,
+        // otherwise the cycle would run with stale outputs.
+        uint8_t *outData = nullptr;
+        size_t outLength = 0;
+        uint8_t *inData = nullptr;
+        size_t inLength = 0;
+        bool hasOutputs = !info[0].IsNull() && !info[0].IsUndefined();
+        bool hasInputs = !info[1].IsNull() && !info[1].IsUndefined();
+        if ((hasOutputs && !viewBytes(info[0], outData, outLength)) || (hasInputs && !viewBytes(info[1], inData, inLength)))
+        {
+            status[0] = -1;
+            Napi::TypeError::New(env, "exchange: outputs and inputs must be ArrayBufferViews or null").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        const ec_groupt &grp = ctx_.grouplist[group];
+
+        if (grp.outputs && outData)
+            std::memcpy(grp.outputs, outData, outLength < grp.Obytes ? outLength : grp.Obytes);
+
+        auto t1 = std::chrono::steady_clock::now();
+        redundancyArm();
+        ecx_send_processdata_group(&ctx_, static_cast<uint8>(group));
+        redundancySent();
+        int wkc = ecx_receive_processdata_group(&ctx_, static_cast<uint8>(group), timeout);
+        auto t2 = std::chrono::steady_clock::now();
+        redundancyTrack(wkc, static_cast<uint8>(group));
+        historianRecord(wkc, static_cast<uint8>(group));
+        if (diag_)
+            diag_->collectErrors();
+
+        if (grp.inputs && inData)
+            std::memcpy(inData, grp.inputs, inLength < grp.Ibytes ? inLength : grp.Ibytes);
+
+        auto t3 = std::chrono::steady_clock::now();
+        status[0] = wkc;
+        status[1] = grp.outputsWKC * 2 + grp.inputsWKC;
+        status[2] = static_cast<int32_t>(std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+        status[3] = static_cast<int32_t>(std::chrono::duration_cast<std::chrono::microseconds>(t3 - t0).count());
+        if (mbx_)
+            mbx_->cycleDone(t0, t3);
+        return env.Undefined();
+    }
+
+    Napi::Value Master::processImageLayout(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        int group = 0;
+        if (info.Length() >= 1 && info[0].IsNumber())
+            group = info[0].As<Napi::Number>().Int32Value();
+        if (group < 0 || group >= EC_MAXGROUP || hotplugging(static_cast<uint8>(group)))
+            return env.Null();
+        const ec_groupt &grp = ctx_.grouplist[group];
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("outputsBytes", Napi::Number::New(env, grp.Obytes));
+        o.Set("inputsBytes", Napi::Number::New(env, grp.Ibytes));
+        o.Set("expectedWkc", Napi::Number::New(env, grp.outputsWKC * 2 + grp.inputsWKC));
+        return o;
+    }
+
+    void Master::historianRecord(int wkc, uint8 group)
+    {
+        if (!hist_ || group != histGroup_)
+            return;
+        const ec_groupt &grp = ctx_.grouplist[group];
+        if (mapGeneration_[group] != histGeneration_)
+        {
+            // The group was mapped again: the ranges checked by startHistorian
+            // may now lie past the image. Keep recording only if they still fit.
+            if ((!grp.outputs && !grp.inputs) || groupImageBytes(grp) < histExtent_)
+            {
+                hist_->stop();
+                hist_.reset();
+                return;
+            }
+            histGeneration_ = mapGeneration_[group];
+        }
+        int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        hist_->record(ns, wkc, grp.outputs ? grp.outputs : grp.inputs);
+    }
+
+    Napi::Value Master::startHistorian(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsObject())
+        {
+            Napi::TypeError::New(env, "startHistorian expects an options object").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Object o = info[0].As<Napi::Object>();
+        Napi::Value dir = o.Get("dir");
+        if (!dir.IsString())
+        {
+            Napi::TypeError::New(env, "startHistorian: dir must be a string").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        if (!opened_)
+            return Napi::Boolean::New(env, false);
+        uint32_t group = 0;
+        Napi::Value g = o.Get("group");
+        if (g.IsNumber())
+            group = g.As<Napi::Number>().Uint32Value();
+        if (group >= EC_MAXGROUP || hotplugging(static_cast<uint8>(group)))
+            return Napi::Boolean::New(env, false);
+        const ec_groupt &grp = ctx_.grouplist[group];
+        if (!grp.outputs && !grp.inputs)
+            return Napi::Boolean::New(env, false);
+
+        // Offsets are relative to the start of the group image (outputs, then inputs).
+        uint32_t imageBytes = groupImageBytes(grp);
+
+        Historian::Options opt;
+        opt.dir = dir.As<Napi::String>().Utf8Value();
+        Napi::Value ranges = o.Get("ranges");
+        if (ranges.IsArray())
+        {
+            Napi::Array arr = ranges.As<Napi::Array>();
+            for (uint32_t i = 0; i < arr.Length(); i++)
+            {
+                Napi::Value item = arr.Get(i);
+                if (!item.IsObject())
+                    continue;
+                Napi::Object r = item.As<Napi::Object>();
+                Napi::Value off = r.Get("offset");
+                Napi::Value len = r.Get("length");
+                if (!off.IsNumber() || !len.IsNumber())
+                    continue;
+                Historian::Range range{off.As<Napi::Number>().Uint32Value(), len.As<Napi::Number>().Uint32Value()};
+                if (range.length == 0 || range.offset >= imageBytes || range.length > imageBytes - range.offset)
+                {
+                    Napi::RangeError::New(env, "startHistorian: range outside the process image").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+                opt.ranges.push_back(range);
+            }
+        }
+        else
+        {
+            opt.ranges.push_back({0, imageBytes});
+        }
+        uint32_t extent = 0;
+        for (const Historian::Range &r : opt.ranges)
+            extent = std::max(extent, r.offset + r.length);
+        Napi::Value seg = o.Get("segmentBytes");
+        if (seg.IsNumber() && seg.As<Napi::Number>().DoubleValue() > 0)
+            opt.segmentBytes = static_cast<uint64_t>(seg.As<Napi::Number>().DoubleValue());
+        opt.maxSegments = optionU32(o, "maxSegments", opt.maxSegments);
+        opt.blockRecords = optionU32(o, "blockRecords", opt.blockRecords);
+        opt.ringRecords = optionU32(o, "ringRecords", opt.ringRecords);
+        opt.flushIntervalMs = optionU32(o, "flushIntervalMs", opt.flushIntervalMs);
+
+        if (hist_)
+            hist_->stop();
+        std::unique_ptr<Historian> h(new Historian());
+        std::string err;
+        if (!h->start(opt, err))
+        {
+            hist_.reset();
+            Napi::Error::New(env, "startHistorian: " + err).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        hist_ = std::move(h);
+        histGroup_ = static_cast<uint8>(group);
+        histGeneration_ = mapGeneration_[group];
+        histExtent_ = extent;
+        return Napi::Boolean::New(env, true);
+    }
+
+    Napi::Value Master::stopHistorian(const Napi::CallbackInfo &info)
+    {
+        // Joins the writer, which flushes the last partial block.
+        if (hist_)
+        {
+            hist_->stop();
+            hist_.reset();
+        }
+        return info.Env().Undefined();
+    }
+
+    Napi::Value Master::historianStatus(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("running", Napi::Boolean::New(env, static_cast<bool>(hist_)));
+        Historian::Stats st = hist_ ? hist_->stats() : Historian::Stats{0, 0, 0, 0, 0};
+        o.Set("recordSize", Napi::Number::New(env, hist_ ? hist_->recordSize() : 0));
+        o.Set("recorded", Napi::Number::New(env, static_cast<double>(st.recorded)));
+        o.Set("dropped", Napi::Number::New(env, static_cast<double>(st.dropped)));
+        o.Set("blocks", Napi::Number::New(env, static_cast<double>(st.blocks)));
+        o.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(st.bytesWritten)));
+        o.Set("segment", Napi::Number::New(env, static_cast<double>(st.segment)));
+        return o;
+    }
+
+    Napi::Value Master::readHistory(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsString())
+        {
+            Napi::Promise::Deferred d = Napi::Promise::Deferred::New(env);
+            d.Reject(Napi::TypeError::New(env, "readHistory expects a directory").Value());
+            return d.Promise();
+        }
+        std::string dir = info[0].As<Napi::String>().Utf8Value();
+        int64_t from = info.Length() >= 2 ? historyTime(info[1], INT64_MIN) : INT64_MIN;
+        int64_t to = info.Length() >= 3 ? historyTime(info[2], INT64_MAX) : INT64_MAX;
+        size_t maxRecords = 0;
+        if (info.Length() >= 4 && info[3].IsNumber())
+            maxRecords = static_cast<size_t>(info[3].As<Napi::Number>().Uint32Value());
+        HistoryReadWorker *worker = new HistoryReadWorker(env, dir, from, to, maxRecords);
+        Napi::Promise promise = worker->Promise();
+        worker->Queue();
+        return promise;
     }
 
     Napi::Value Master::mbxHandler(const Napi::CallbackInfo &info)
@@ -276,13 +1809,88 @@ namespace soemnode
             group = info[0].As<Napi::Number>().Int32Value();
         if (info.Length() >= 2 && info[1].IsNumber())
             limit = info[1].As<Napi::Number>().Int32Value();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "mbxHandler"))
+            return env.Undefined();
         int ret = ecx_mbxhandler(&ctx_, static_cast<uint8>(group), limit);
         return Napi::Number::New(env, ret);
     }
 
+    void Master::ensureDiagnostics()
+    {
+        if (diag_)
+            return;
+        diag_.reset(new Diagnostics(&ctx_, mailboxLock_));
+        diag_->configure(diagConfig_);
+    }
+
+    Napi::Value Master::configureDiagnostics(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() >= 1 && info[0].IsObject())
+        {
+            Napi::Object o = info[0].As<Napi::Object>();
+            diagConfig_.capacity = optionU32(o, "capacity", diagConfig_.capacity);
+            diagConfig_.slavesPerPoll = optionU32(o, "slavesPerPoll", diagConfig_.slavesPerPoll);
+            // 0 is meaningful here: no counter polling.
+            Napi::Value v = o.Get("counterIntervalMs");
+            if (v.IsNumber())
+                diagConfig_.counterIntervalMs = v.As<Napi::Number>().Uint32Value();
+        }
+        if (diag_)
+            diag_->configure(diagConfig_);
+        else if (opened_)
+            ensureDiagnostics();
+        return env.Undefined();
+    }
+
+    Napi::Value Master::drainDiagnostics(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        uint8_t *data = nullptr;
+        size_t length = 0;
+        if (!opened_ || info.Length() < 1 || !viewBytes(info[0], data, length))
+            return Napi::Number::New(env, -1);
+        ensureDiagnostics();
+        diag_->collectErrors();
+        // Staged through an aligned batch: the target may be any byte view.
+        Diagnostics::Record batch[64];
+        size_t max = length / sizeof(Diagnostics::Record);
+        size_t total = 0;
+        while (total < max)
+        {
+            size_t want = max - total < 64 ? max - total : 64;
+            size_t n = diag_->drain(batch, want);
+            if (n == 0)
+                break;
+            std::memcpy(data + total * sizeof(Diagnostics::Record), batch, n * sizeof(Diagnostics::Record));
+            total += n;
+        }
+        return Napi::Number::New(env, static_cast<double>(total));
+    }
+
+    Napi::Value Master::diagnosticsStatus(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        Napi::Object o = Napi::Object::New(env);
+        Diagnostics::Stats st = diag_ ? diag_->stats() : Diagnostics::Stats{diagConfig_.capacity, 0, 0, 0, 0};
+        o.Set("running", Napi::Boolean::New(env, static_cast<bool>(diag_)));
+        o.Set("capacity", Napi::Number::New(env, st.capacity));
+        o.Set("pending", Napi::Number::New(env, st.pending));
+        o.Set("recorded", Napi::Number::New(env, static_cast<double>(st.recorded)));
+        o.Set("overwritten", Napi::Number::New(env, static_cast<double>(st.overwritten)));
+        o.Set("counterPolls", Napi::Number::New(env, static_cast<double>(st.counterPolls)));
+        return o;
+    }
+
     Napi::Value Master::elist2string(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
+        // ecx_elist2string pops the list that the mailbox workers push to.
+        // Never wait for a transfer in progress: report "busy" as null.
+        std::unique_lock<std::mutex> lock(mailboxLock_, std::try_to_lock);
+        if (!lock.owns_lock())
+            return env.Null();
         char *s = ecx_elist2string(&ctx_);
         if (!s)
             return env.Null();
@@ -299,14 +1907,46 @@ namespace soemnode
         uint8 driveNo = static_cast<uint8>(info[1].As<Napi::Number>().Uint32Value());
         uint8 elementflags = static_cast<uint8>(info[2].As<Napi::Number>().Uint32Value());
         uint16 idn = static_cast<uint16>(info[3].As<Napi::Number>().Uint32Value());
-        uint8 buf[2048];
-        int sz = sizeof(buf);
+        size_t maxSize = kDefaultTransferSize;
+        if (info.Length() >= 5 && info[4].IsNumber())
+            maxSize = info[4].As<Napi::Number>().Uint32Value();
+        if (maxSize > static_cast<size_t>(INT_MAX))
+            maxSize = INT_MAX;
+        // Fragmented SoE responses are reassembled by ecx_SoEread into the container.
+        std::vector<uint8> oversize;
+        uint8 *buf = scratch(maxSize, oversize);
+        int sz = static_cast<int>(maxSize);
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "SoEread"))
+            return env.Undefined();
         int wkc = ecx_SoEread(&ctx_, slave, driveNo, elementflags, idn, &sz, buf, EC_TIMEOUTRXM);
         if (wkc <= 0)
             return env.Null();
         return Napi::Buffer<uint8_t>::Copy(env, buf, sz);
     }
 
+    Napi::Value Master::SoEreadInto(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 5)
+            return Napi::Number::New(env, -1);
+        uint16 slave = static_cast<uint16>(info[0].As<Napi::Number>().Uint32Value());
+        uint8 driveNo = static_cast<uint8>(info[1].As<Napi::Number>().Uint32Value());
+        uint8 elementflags = static_cast<uint8>(info[2].As<Napi::Number>().Uint32Value());
+        uint16 idn = static_cast<uint16>(info[3].As<Napi::Number>().Uint32Value());
+        uint8_t *dst = nullptr;
+        int sz = 0;
+        if (!targetWindow(info, 4, dst, sz))
+            return Napi::Number::New(env, -1);
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "SoEreadInto"))
+            return env.Undefined();
+        int wkc = ecx_SoEread(&ctx_, slave, driveNo, elementflags, idn, &sz, dst, EC_TIMEOUTRXM);
+        if (wkc <= 0)
+            return Napi::Number::New(env, -1);
+        return Napi::Number::New(env, sz);
+    }
+
     Napi::Value Master::SoEwrite(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
@@ -318,6 +1958,9 @@ namespace soemnode
         uint16 idn = static_cast<uint16>(info[3].As<Napi::Number>().Uint32Value());
         Napi::Buffer<uint8_t> data = info[4].As<Napi::Buffer<uint8_t>>();
         int sz = static_cast<int>(data.Length());
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "SoEwrite"))
+            return env.Undefined();
         int wkc = ecx_SoEwrite(&ctx_, slave, driveNo, elementflags, idn, sz, data.Data(), EC_TIMEOUTRXM);
         return Napi::Boolean::New(env, wkc > 0);
     }
@@ -332,6 +1975,9 @@ namespace soemnode
         int timeout = EC_TIMEOUTRET;
         if (info.Length() >= 3 && info[2].IsNumber())
             timeout = info[2].As<Napi::Number>().Int32Value();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "readeeprom"))
+            return env.Undefined();
         uint32 val = ecx_readeeprom(&ctx_, slave, eeproma, timeout);
         return Napi::Number::New(env, val);
     }
@@ -347,6 +1993,9 @@ namespace soemnode
         int timeout = EC_TIMEOUTRET;
         if (info.Length() >= 4 && info[3].IsNumber())
             timeout = info[3].As<Napi::Number>().Int32Value();
+        std::unique_lock<std::mutex> lock;
+        if (!lockMailbox(env, lock, "writeeeprom"))
+            return env.Undefined();
         int ret = ecx_writeeeprom(&ctx_, slave, eeproma, data, timeout);
         return Napi::Number::New(env, ret);
     }
@@ -467,26 +2116,84 @@ namespace soemnode
         return Napi::Boolean::New(env, true);
     }
 
+    int Master::sendGroup(uint8 group)
+    {
+        if (hotplugging(group))
+            return 0;
+        cycleStart_ = std::chrono::steady_clock::now();
+        redundancyArm();
+        int ret = ecx_send_processdata_group(&ctx_, group);
+        redundancySent();
+        return ret;
+    }
+
+    int Master::receiveGroup(uint8 group, int timeout)
+    {
+        if (hotplugging(group))
+            return EC_NOFRAME;
+        int wkc = ecx_receive_processdata_group(&ctx_, group, timeout);
+        redundancyTrack(wkc, group);
+        historianRecord(wkc, group);
+        if (diag_)
+            diag_->collectErrors();
+        if (mbx_)
+            mbx_->cycleDone(cycleStart_, std::chrono::steady_clock::now());
+        return wkc;
+    }
+
     Napi::Value Master::sendProcessdata(const Napi::CallbackInfo &info)
     {
-        int wkc = ecx_send_processdata(&ctx_);
-        return Napi::Number::New(info.Env(), wkc);
+        return Napi::Number::New(info.Env(), sendGroup(0));
     }
 
     Napi::Value Master::receiveProcessdata(const Napi::CallbackInfo &info)
     {
-        int wkc = ecx_receive_processdata(&ctx_, EC_TIMEOUTRET);
-        return Napi::Number::New(info.Env(), wkc);
+        int timeout = EC_TIMEOUTRET;
+        if (info.Length() >= 1 && info[0].IsNumber())
+            timeout = info[0].As<Napi::Number>().Int32Value();
+        return Napi::Number::New(info.Env(), receiveGroup(0, timeout));
     }
 
     Napi::Value Master::close(const Napi::CallbackInfo &info)
+    {
+        shutdown();
+        return info.Env().Undefined();
+    }
+
+    void Master::shutdown()
     {
         if (opened_)
         {
+            // Background workers stop at their next transaction boundary.
+            {
+                std::unique_lock<std::mutex> lock(bgMtx_);
+                closing_ = true;
+                bgCv_.wait(lock, [this]
+                           { return bgActive_ == 0; });
+            }
+            if (hist_)
+            {
+                hist_->stop();
+                hist_.reset();
+            }
+            if (diag_)
+            {
+                diag_->stop();
+                diag_.reset();
+            }
+            // Queued acyclic requests are rejected as cancelled before the port
+            // goes away; the one in progress completes normally.
+            if (mbx_)
+            {
+                mbx_->stop();
+                mbx_.reset();
+                settleOrphans(Env());
+            }
             ecx_close(&ctx_);
             opened_ = false;
+            redundant_ = false;
+            closing_ = false;
         }
-        return info.Env().Undefined();
     }
 
     Napi::Value Master::listInterfaces(const Napi::CallbackInfo &info)
@@ -537,15 +2244,22 @@ namespace soemnode
 
     Napi::Function Master::Init(Napi::Env env)
     {
-        Napi::Function func = DefineClass(env, "Master", {InstanceMethod("init", &Master::init), InstanceMethod("configInit", &Master::configInit), InstanceMethod("configMapPDO", &Master::configMapPDO), InstanceMethod("configMapGroup", &Master::configMapGroup), InstanceMethod("state", &Master::state), InstanceMethod("readState", &Master::readState), InstanceMethod("sdoRead", &Master::sdoRead), InstanceMethod("sdoWrite", &Master::sdoWrite), InstanceMethod("sendProcessdata", &Master::sendProcessdata), InstanceMethod("sendProcessdataGroup", &Master::sendProcessdataGroup), InstanceMethod("receiveProcessdata", &Master::receiveProcessdata), InstanceMethod("receiveProcessdataGroup", &Master::receiveProcessdataGroup), InstanceMethod("close", &Master::close), InstanceMethod("writeState", &Master::writeState), InstanceMethod("stateCheck", &Master::stateCheck), InstanceMethod("reconfigSlave", &Master::reconfigSlave), InstanceMethod("recoverSlave", &Master::recoverSlave), InstanceMethod("slaveMbxCyclic", &Master::slaveMbxCyclic), InstanceMethod("mbxHandler", &Master::mbxHandler), InstanceMethod("configDC", &Master::configDC), InstanceMethod("dcsync0", &Master::dcsync0), InstanceMethod("dcsync01", &Master::dcsync01), InstanceMethod("getSlaves", &Master::getSlaves), InstanceMethod("elist2string", &Master::elist2string), InstanceMethod("SoEread", &Master::SoEread), InstanceMethod("SoEwrite", &Master::SoEwrite), InstanceMethod("readeeprom", &Master::readeeprom), InstanceMethod("writeeeprom", &Master::writeeeprom), InstanceMethod("initRedundant", &Master::initRedundant), StaticMethod("listInterfaces", &Master::listInterfaces)});
+        Napi::Function func = DefineClass(env, "Master", {InstanceMethod("init", &Master::init), InstanceMethod("configInit", &Master::configInit), InstanceMethod("configMapPDO", &Master::configMapPDO), InstanceMethod("configMapGroup", &Master::configMapGroup), InstanceMethod("state", &Master::state), InstanceMethod("readState", &Master::readState), InstanceMethod("sdoRead", &Master::sdoRead), InstanceMethod("sdoReadInto", &Master::sdoReadInto), InstanceMethod("sdoWrite", &Master::sdoWrite), InstanceMethod("sendProcessdata", &Master::sendProcessdata), InstanceMethod("sendProcessdataGroup", &Master::sendProcessdataGroup), InstanceMethod("receiveProcessdata", &Master::receiveProcessdata), InstanceMethod("receiveProcessdataGroup", &Master::receiveProcessdataGroup), InstanceMethod("exchange", &Master::exchange), InstanceMethod("processImageLayout", &Master::processImageLayout), InstanceMethod("close", &Master::close), InstanceMethod("writeState", &Master::writeState), InstanceMethod("stateCheck", &Master::stateCheck), InstanceMethod("reconfigSlave", &Master::reconfigSlave), InstanceMethod("recoverSlave", &Master::recoverSlave), InstanceMethod("slaveMbxCyclic", &Master::slaveMbxCyclic), InstanceMethod("mbxHandler", &Master::mbxHandler), InstanceMethod("configureMailbox", &Master::configureMailbox), InstanceMethod("mailboxSubmit", &Master::mailboxSubmit), InstanceMethod("mailboxStatus", &Master::mailboxStatus), InstanceMethod("configDC", &Master::configDC), InstanceMethod("dcsync0", &Master::dcsync0), InstanceMethod("dcsync01", &Master::dcsync01), InstanceMethod("getSlaves", &Master::getSlaves), InstanceMethod("scanTopology", &Master::scanTopology), InstanceMethod("configNewSlaves", &Master::configNewSlaves), InstanceMethod("slaveIdentity", &Master::slaveIdentity), InstanceMethod("readObjectDictionary", &Master::readObjectDictionary), InstanceMethod("elist2string", &Master::elist2string), InstanceMethod("configureDiagnostics", &Master::configureDiagnostics), InstanceMethod("drainDiagnostics", &Master::drainDiagnostics), InstanceMethod("diagnosticsStatus", &Master::diagnosticsStatus), InstanceMethod("startHistorian", &Master::startHistorian), InstanceMethod("stopHistorian", &Master::stopHistorian), InstanceMethod("historianStatus", &Master::historianStatus), InstanceMethod("SoEread", &Master::SoEread), InstanceMethod("SoEreadInto", &Master::SoEreadInto), InstanceMethod("SoEwrite", &Master::SoEwrite), InstanceMethod("readeeprom", &Master::readeeprom), InstanceMethod("writeeeprom", &Master::writeeeprom), InstanceMethod("initRedundant", &Master::initRedundant), InstanceMethod("redundancyStatus", &Master::redundancyStatus), StaticMethod("listInterfaces", &Master::listInterfaces), StaticMethod("readHistory", &Master::readHistory)});
         constructor = Napi::Persistent(func);
         constructor.SuppressDestruct();
         return func;
     }
 
+    Master *Master::Create(Napi::Env env, const std::string &ifname, Napi::Object &wrapper)
+    {
+        wrapper = constructor.New({Napi::String::New(env, ifname)});
+        return Master::Unwrap(wrapper);
+    }
+
     Napi::Object InitAll(Napi::Env env, Napi::Object exports)
     {
         exports.Set("Master", Master::Init(env));
+        exports.Set("NodeSoemMaster", NodeSoemMasterInit(env));
         return exports;
     }
 
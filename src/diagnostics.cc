@@ -0,0 +1,231 @@
+// Platform-specific includes
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#endif
+
+#include "diagnostics.hpp"
+
+#include <chrono>
+#include <cstring>
+
+namespace soemnode
+{
+
+    namespace
+    {
+        // ESC error counter block, 0x0300 - 0x0313.
+        constexpr uint16 kCounterBase = 0x0300;
+        constexpr uint16 kCounterBytes = 20;
+
+        uint32_t increment(uint8_t prev, uint8_t cur)
+        {
+            // Counters saturate at 0xFF and are cleared by writing; a drop means cleared.
+            return cur >= prev ? static_cast<uint32_t>(cur - prev) : cur;
+        }
+    }
+
+    Diagnostics::Diagnostics(ecx_contextt *ctx, std::mutex &ctxLock) : ctx_(ctx), ctxLock_(ctxLock)
+    {
+        ring_.resize(cfg_.capacity);
+    }
+
+    Diagnostics::~Diagnostics()
+    {
+        stop();
+    }
+
+    int64_t Diagnostics::nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void Diagnostics::configure(const Config &cfg)
+    {
+        stop();
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            cfg_ = cfg;
+            if (cfg_.capacity == 0)
+                cfg_.capacity = 1;
+            if (cfg_.slavesPerPoll == 0)
+                cfg_.slavesPerPoll = 1;
+            if (ring_.size() != cfg_.capacity)
+            {
+                ring_.assign(cfg_.capacity, Record());
+                head_ = 0;
+                count_ = 0;
+            }
+            stopping_ = false;
+        }
+        if (cfg_.counterIntervalMs > 0)
+            thread_ = std::thread(&Diagnostics::loop, this);
+    }
+
+    void Diagnostics::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stopping_ = true;
+            cv_.notify_all();
+        }
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void Diagnostics::push(const Record &r)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ring_[(head_ + count_) % ring_.size()] = r;
+        if (count_ < ring_.size())
+            count_++;
+        else
+        {
+            head_ = (head_ + 1) % ring_.size();
+            overwritten_++;
+        }
+        recorded_++;
+    }
+
+    void Diagnostics::collectErrors()
+    {
+        if (!ecx_iserror(ctx_))
+            return;
+        // Never wait on the cyclic side: a mailbox transfer can hold the lock
+        // for a whole SDO timeout.
+        std::unique_lock<std::mutex> ctxLock(ctxLock_, std::try_to_lock);
+        if (!ctxLock.owns_lock())
+            return;
+        ec_errort e;
+        while (ecx_poperror(ctx_, &e))
+        {
+            Record r = {};
+            r.timestampNs = nowNs();
+            r.slave = e.Slave;
+            r.type = static_cast<uint16_t>(e.Etype);
+            switch (e.Etype)
+            {
+            case EC_ERR_TYPE_EMERGENCY:
+                r.code = e.ErrorCode;
+                r.detail = e.ErrorReg | (e.b1 << 8);
+                r.aux = static_cast<uint32_t>(e.w1) | (static_cast<uint32_t>(e.w2) << 16);
+                break;
+            case EC_ERR_TYPE_PACKET_ERROR:
+                r.code = e.ErrorCode;
+                r.detail = (e.Index << 8) | e.SubIdx;
+                break;
+            default:
+                r.code = static_cast<uint32_t>(e.AbortCode);
+                r.detail = (e.Index << 8) | e.SubIdx;
+                break;
+            }
+            push(r);
+        }
+    }
+
+    size_t Diagnostics::drain(Record *out, size_t max)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        size_t n = count_ < max ? count_ : max;
+        for (size_t i = 0; i < n; i++)
+            out[i] = ring_[(head_ + i) % ring_.size()];
+        head_ = (head_ + n) % ring_.size();
+        count_ -= n;
+        return n;
+    }
+
+    Diagnostics::Stats Diagnostics::stats()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Stats s;
+        s.capacity = static_cast<uint32_t>(ring_.size());
+        s.pending = static_cast<uint32_t>(count_);
+        s.recorded = recorded_;
+        s.overwritten = overwritten_;
+        s.counterPolls = polls_.load();
+        return s;
+    }
+
+    void Diagnostics::pollCounters(uint16_t slave, int64_t now)
+    {
+        SlaveCounters &sc = counters_[slave];
+        uint8_t regs[kCounterBytes] = {0};
+        int wkc;
+        {
+            std::lock_guard<std::mutex> ctxLock(ctxLock_);
+            wkc = ecx_FPRD(&ctx_->port, ctx_->slavelist[slave].configadr, kCounterBase, kCounterBytes, regs, EC_TIMEOUTRET);
+        }
+        if (wkc <= 0)
+        {
+            if (!sc.lost)
+            {
+                sc.lost = true;
+                push(Record{now, slave, SLAVE_NO_RESPONSE, 0, wkc, 0});
+            }
+            return;
+        }
+        if (sc.lost)
+        {
+            sc.lost = false;
+            push(Record{now, slave, SLAVE_RESPONDING, 0, 0, 0});
+        }
+        if (sc.valid)
+        {
+            auto emit = [&](uint16_t type, uint32_t code, int at)
+            {
+                uint32_t d = increment(sc.regs[at], regs[at]);
+                if (d)
+                    push(Record{now, slave, type, code, static_cast<int32_t>(d), regs[at]});
+            };
+            for (uint32_t p = 0; p < 4; p++)
+            {
+                emit(ESC_INVALID_FRAME, p, 2 * p);
+                emit(ESC_RX_ERROR, p, 2 * p + 1);
+                emit(ESC_FORWARDED_ERROR, p, 8 + p);
+                emit(ESC_LOST_LINK, p, 16 + p);
+            }
+            emit(ESC_PROCESSING_UNIT, 0, 12);
+            emit(ESC_PDI_ERROR, 0, 13);
+        }
+        std::memcpy(sc.regs, regs, kCounterBytes);
+        sc.valid = true;
+    }
+
+    void Diagnostics::loop()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!stopping_)
+        {
+            cv_.wait_for(lock, std::chrono::milliseconds(cfg_.counterIntervalMs));
+            if (stopping_)
+                break;
+            uint32_t batch = cfg_.slavesPerPoll;
+            lock.unlock();
+
+            int slaves;
+            {
+                // configNewSlaves raises slavecount under this lock.
+                std::lock_guard<std::mutex> ctxLock(ctxLock_);
+                slaves = ctx_->slavecount;
+            }
+            if (slaves > 0)
+            {
+                if (counters_.size() < static_cast<size_t>(slaves) + 1)
+                    counters_.resize(static_cast<size_t>(slaves) + 1);
+                int64_t now = nowNs();
+                for (uint32_t i = 0; i < batch && i < static_cast<uint32_t>(slaves); i++)
+                {
+                    if (cursor_ < 1 || cursor_ > slaves)
+                        cursor_ = 1;
+                    pollCounters(cursor_++, now);
+                }
+                polls_++;
+            }
+            lock.lock();
+        }
+    }
+
+} // namespace soemnode
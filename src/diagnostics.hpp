@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "ethercat.h"
+}
+
+namespace soemnode
+{
+
+    // Fixed-size ring of binary diagnostic events. Entries come from two
+    // sources: SOEM's error list (drained on the cyclic side, no frames) and
+    // the ESC error counters (0x0300-0x0313), read in small round-robin
+    // batches by a low-rate thread. Only increments of a counter produce an
+    // event. When the ring is full the oldest events are overwritten.
+    // Popping SOEM's error list takes its entries away from ecx_elist2string.
+    // The list and the slave table are shared with the mailbox workers, so
+    // both sources take the context lock.
+    class Diagnostics
+    {
+    public:
+        // 24 bytes, little endian, as copied to JS.
+        struct Record
+        {
+            int64_t timestampNs; // ns since the Unix epoch
+            uint16_t slave;
+            uint16_t type;       // ec_err_type value, or one of the ESC types below
+            uint32_t code;
+            int32_t detail;
+            uint32_t aux;
+        };
+        static_assert(sizeof(Record) == 24, "diagnostic record layout");
+
+        enum Type : uint16_t
+        {
+            // Values below 0x100 are SOEM ec_err_type.
+            ESC_RX_ERROR = 0x100,       // code: port, detail: increment, aux: counter
+            ESC_INVALID_FRAME = 0x101,  // code: port
+            ESC_FORWARDED_ERROR = 0x102, // code: port
+            ESC_PROCESSING_UNIT = 0x103,
+            ESC_PDI_ERROR = 0x104,
+            ESC_LOST_LINK = 0x105,      // code: port
+            SLAVE_NO_RESPONSE = 0x110,  // counters could not be read, detail: wkc
+            SLAVE_RESPONDING = 0x111    // readable again after SLAVE_NO_RESPONSE
+        };
+
+        struct Config
+        {
+            uint32_t capacity = 1024;
+            // 0 disables the counter thread.
+            uint32_t counterIntervalMs = 1000;
+            uint32_t slavesPerPoll = 16;
+        };
+
+        struct Stats
+        {
+            uint32_t capacity;
+            uint32_t pending;
+            uint64_t recorded;
+            uint64_t overwritten;
+            uint64_t counterPolls;
+        };
+
+        Diagnostics(ecx_contextt *ctx, std::mutex &ctxLock);
+        ~Diagnostics();
+        Diagnostics(const Diagnostics &) = delete;
+        Diagnostics &operator=(const Diagnostics &) = delete;
+
+        void configure(const Config &cfg);
+        void stop();
+
+        // Moves the SOEM error list into the ring. Cheap when it is empty; when
+        // the context lock is busy the entries are left for the next call.
+        void collectErrors();
+
+        // Copies up to max records into out, oldest first. Returns the count.
+        size_t drain(Record *out, size_t max);
+
+        Stats stats();
+
+    private:
+        struct SlaveCounters
+        {
+            uint8_t regs[20];
+            bool valid = false;
+            bool lost = false;
+        };
+
+        void push(const Record &r);
+        void loop();
+        void pollCounters(uint16_t slave, int64_t now);
+        static int64_t nowNs();
+
+        ecx_contextt *ctx_;
+        std::mutex &ctxLock_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        Config cfg_;
+        std::vector<Record> ring_;
+        size_t head_ = 0;
+        size_t count_ = 0;
+        uint64_t recorded_ = 0;
+        uint64_t overwritten_ = 0;
+        std::atomic<uint64_t> polls_{0};
+
+        // Counter thread state
+        std::vector<SlaveCounters> counters_;
+        uint16_t cursor_ = 1;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+
+} // namespace soemnode
@@ -0,0 +1,625 @@
+// Platform-specific includes
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "historian.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace soemnode
+{
+
+    namespace
+    {
+        const char kSegmentMagic[8] = {'S', 'O', 'E', 'M', 'H', 'I', 'S', '1'};
+        constexpr uint32_t kBlockMagic = 0x314B4C42; // "BLK1"
+        // Version 1 stored wall-clock timestamps and zeros in place of the
+        // clock bases, so it reads correctly with a zero offset.
+        constexpr uint32_t kVersion = 2;
+        constexpr uint32_t kMaxToken = 0xFFFF;
+        // Shorter zero runs stay inside the literal; a token costs 4 bytes.
+        constexpr uint32_t kMinZeroRun = 4;
+
+        struct SegmentHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t recordSize;
+            uint64_t dataEnd;
+            int64_t firstTs;
+            int64_t lastTs;
+            uint64_t records;
+            // Wall-clock and steady_clock ns sampled together at creation.
+            int64_t wallBaseNs;
+            int64_t steadyBaseNs;
+        };
+        static_assert(sizeof(SegmentHeader) == 64, "segment header layout");
+
+        struct BlockHeader
+        {
+            uint32_t magic;
+            uint32_t count;
+            int64_t firstTs;
+            int64_t lastTs;
+            uint32_t payloadBytes;
+            uint32_t reserved;
+        };
+        static_assert(sizeof(BlockHeader) == 32, "block header layout");
+
+        // Read-write or read-only mapping of a whole file.
+        class MappedFile
+        {
+        public:
+            ~MappedFile() { unmap(); }
+
+            bool open(const std::string &path, uint64_t size, bool writable)
+            {
+#ifdef _WIN32
+                file_ = CreateFileA(path.c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                    writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file_ == INVALID_HANDLE_VALUE)
+                    return false;
+                if (!writable)
+                {
+                    LARGE_INTEGER sz;
+                    if (!GetFileSizeEx(file_, &sz) || sz.QuadPart == 0)
+                        return false;
+                    size = static_cast<uint64_t>(sz.QuadPart);
+                }
+                mapping_ = CreateFileMappingA(file_, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                              static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+                if (!mapping_)
+                    return false;
+                data_ = static_cast<uint8_t *>(MapViewOfFile(mapping_, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size)));
+                if (!data_)
+                    return false;
+#else
+                fd_ = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY, 0644);
+                if (fd_ < 0)
+                    return false;
+                if (writable)
+                {
+                    if (ftruncate(fd_, static_cast<off_t>(size)) != 0)
+                        return false;
+                }
+                else
+                {
+                    struct stat st;
+                    if (fstat(fd_, &st) != 0 || st.st_size == 0)
+                        return false;
+                    size = static_cast<uint64_t>(st.st_size);
+                }
+                void *p = mmap(nullptr, static_cast<size_t>(size), writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd_, 0);
+                if (p == MAP_FAILED)
+                    return false;
+                data_ = static_cast<uint8_t *>(p);
+#endif
+                size_ = size;
+                return true;
+            }
+
+            // Unmaps and, for writable files, trims the file to the bytes in use.
+            void unmap(uint64_t keepBytes = 0)
+            {
+#ifdef _WIN32
+                if (data_)
+                    UnmapViewOfFile(data_);
+                if (mapping_)
+                    CloseHandle(mapping_);
+                if (file_ != INVALID_HANDLE_VALUE)
+                {
+                    if (keepBytes)
+                    {
+                        LARGE_INTEGER pos;
+                        pos.QuadPart = static_cast<LONGLONG>(keepBytes);
+                        if (SetFilePointerEx(file_, pos, nullptr, FILE_BEGIN))
+                            SetEndOfFile(file_);
+                    }
+                    CloseHandle(file_);
+                }
+                mapping_ = nullptr;
+                file_ = INVALID_HANDLE_VALUE;
+#else
+                if (data_)
+                    munmap(data_, static_cast<size_t>(size_));
+                if (fd_ >= 0)
+                {
+                    if (keepBytes && ftruncate(fd_, static_cast<off_t>(keepBytes)) != 0)
+                    {
+                        // Keeping the preallocated size is harmless: readers stop at dataEnd.
+                    }
+                    ::close(fd_);
+                }
+                fd_ = -1;
+#endif
+                data_ = nullptr;
+                size_ = 0;
+            }
+
+            uint8_t *data() const { return data_; }
+            uint64_t size() const { return size_; }
+
+        private:
+#ifdef _WIN32
+            HANDLE file_ = INVALID_HANDLE_VALUE;
+            HANDLE mapping_ = nullptr;
+#else
+            int fd_ = -1;
+#endif
+            uint8_t *data_ = nullptr;
+            uint64_t size_ = 0;
+        };
+
+        std::string segmentName(uint64_t seq)
+        {
+            char name[40];
+            std::snprintf(name, sizeof(name), "seg-%020llu.hist", static_cast<unsigned long long>(seq));
+            return name;
+        }
+
+        std::vector<fs::path> listSegments(const std::string &dir)
+        {
+            std::vector<fs::path> out;
+            std::error_code ec;
+            for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+            {
+                std::string name = it->path().filename().string();
+                if (name.size() == 29 && name.compare(0, 4, "seg-") == 0 && name.compare(24, 5, ".hist") == 0)
+                    out.push_back(it->path());
+            }
+            std::sort(out.begin(), out.end());
+            return out;
+        }
+
+        size_t worstRecordBytes(uint32_t recordSize)
+        {
+            return sizeof(int64_t) + sizeof(int32_t) + recordSize + 4 * (recordSize / kMaxToken + 2);
+        }
+
+        // Pairs a wall-clock reading with the steady time it was taken at: the
+        // midpoint of the tightest of a few steady / wall / steady reads, so a
+        // preemption between the two clock reads does not skew the offset.
+        void sampleClocks(int64_t &wallNs, int64_t &steadyNs)
+        {
+            using namespace std::chrono;
+            int64_t best = INT64_MAX;
+            for (int i = 0; i < 3; i++)
+            {
+                int64_t s0 = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+                int64_t w = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+                int64_t s1 = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+                if (s1 - s0 < best)
+                {
+                    best = s1 - s0;
+                    wallNs = w;
+                    steadyNs = s0 + (s1 - s0) / 2;
+                }
+            }
+        }
+
+        // Decodes one record of the data column; returns false on a corrupt token stream.
+        bool decodeRecord(const uint8_t *&p, const uint8_t *end, uint8_t *rec, uint32_t recordSize)
+        {
+            uint32_t pos = 0;
+            while (pos < recordSize)
+            {
+                if (end - p < 4)
+                    return false;
+                uint16_t zeros, lit;
+                std::memcpy(&zeros, p, 2);
+                std::memcpy(&lit, p + 2, 2);
+                p += 4;
+                if (zeros == 0 && lit == 0)
+                    return false;
+                if (static_cast<uint64_t>(pos) + zeros + lit > recordSize || end - p < lit)
+                    return false;
+                pos += zeros;
+                for (uint16_t i = 0; i < lit; i++)
+                    rec[pos + i] ^= p[i];
+                p += lit;
+                pos += lit;
+            }
+            return true;
+        }
+    }
+
+    struct Historian::Segment
+    {
+        MappedFile file;
+        SegmentHeader *header = nullptr;
+    };
+
+    Historian::~Historian()
+    {
+        stop();
+    }
+
+    bool Historian::start(const Options &opt, std::string &err)
+    {
+        if (running_)
+        {
+            err = "historian already running";
+            return false;
+        }
+        opt_ = opt;
+        recordSize_ = 0;
+        for (const Range &r : opt_.ranges)
+            recordSize_ += r.length;
+        if (recordSize_ == 0)
+        {
+            err = "nothing to record (empty process image or ranges)";
+            return false;
+        }
+        if (opt_.blockRecords == 0)
+            opt_.blockRecords = 1;
+        if (opt_.ringRecords < 2)
+            opt_.ringRecords = 2;
+        if (opt_.maxSegments == 0)
+            opt_.maxSegments = 1;
+        // A full block must always fit in an empty segment.
+        uint64_t room = opt_.segmentBytes > sizeof(SegmentHeader) + sizeof(BlockHeader) ? opt_.segmentBytes - sizeof(SegmentHeader) - sizeof(BlockHeader) : 0;
+        uint64_t fit = room / worstRecordBytes(recordSize_);
+        if (fit == 0)
+        {
+            err = "segmentBytes too small for one record";
+            return false;
+        }
+        if (opt_.blockRecords > fit)
+            opt_.blockRecords = static_cast<uint32_t>(fit);
+
+        std::error_code ec;
+        fs::create_directories(opt_.dir, ec);
+        std::vector<fs::path> existing = listSegments(opt_.dir);
+        uint64_t seq = 0;
+        if (!existing.empty())
+            seq = std::strtoull(existing.back().filename().string().c_str() + 4, nullptr, 10) + 1;
+        segmentSeq_ = seq;
+
+        slotStride_ = (sizeof(int64_t) + sizeof(int32_t) + recordSize_ + 7) & ~static_cast<size_t>(7);
+        ring_.assign(slotStride_ * opt_.ringRecords, 0);
+        head_ = 0;
+        tail_ = 0;
+        dropped_ = 0;
+        recorded_ = 0;
+        blocks_ = 0;
+        bytesWritten_ = 0;
+        blkTs_.clear();
+        blkWkc_.clear();
+        blkData_.clear();
+        blkTs_.reserve(opt_.blockRecords);
+        blkWkc_.reserve(opt_.blockRecords);
+        blkData_.reserve(opt_.blockRecords * worstRecordBytes(recordSize_));
+        prev_.assign(recordSize_, 0);
+        diff_.assign(recordSize_, 0);
+
+        if (!openSegment())
+        {
+            err = "cannot create segment in " + opt_.dir;
+            return false;
+        }
+        running_ = true;
+        writer_ = std::thread(&Historian::writerLoop, this);
+        return true;
+    }
+
+    void Historian::stop()
+    {
+        if (!running_)
+            return;
+        running_ = false;
+        if (writer_.joinable())
+            writer_.join();
+        closeSegment();
+    }
+
+    void Historian::record(int64_t steadyNs, int32_t wkc, const uint8_t *image)
+    {
+        if (!running_ || !image)
+            return;
+        uint64_t h = head_.load(std::memory_order_relaxed);
+        if (h - tail_.load(std::memory_order_acquire) >= opt_.ringRecords)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        uint8_t *slot = ring_.data() + (h % opt_.ringRecords) * slotStride_;
+        std::memcpy(slot, &steadyNs, sizeof(steadyNs));
+        std::memcpy(slot + sizeof(int64_t), &wkc, sizeof(wkc));
+        uint8_t *dst = slot + sizeof(int64_t) + sizeof(int32_t);
+        for (const Range &r : opt_.ranges)
+        {
+            std::memcpy(dst, image + r.offset, r.length);
+            dst += r.length;
+        }
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    Historian::Stats Historian::stats() const
+    {
+        Stats s;
+        s.recorded = recorded_.load();
+        s.dropped = dropped_.load();
+        s.blocks = blocks_.load();
+        s.bytesWritten = bytesWritten_.load();
+        s.segment = segmentSeq_.load();
+        return s;
+    }
+
+    void Historian::writerLoop()
+    {
+        auto lastFlush = std::chrono::steady_clock::now();
+        for (;;)
+        {
+            bool live = running_.load();
+            uint64_t t = tail_.load(std::memory_order_relaxed);
+            uint64_t h = head_.load(std::memory_order_acquire);
+            while (t != h)
+            {
+                const uint8_t *slot = ring_.data() + (t % opt_.ringRecords) * slotStride_;
+                int64_t ts;
+                int32_t wkc;
+                std::memcpy(&ts, slot, sizeof(ts));
+                std::memcpy(&wkc, slot + sizeof(int64_t), sizeof(wkc));
+                encode(slot + sizeof(int64_t) + sizeof(int32_t), ts, wkc);
+                tail_.store(++t, std::memory_order_release);
+                if (blkTs_.size() >= opt_.blockRecords)
+                {
+                    flushBlock();
+                    lastFlush = std::chrono::steady_clock::now();
+                }
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (!live || (!blkTs_.empty() && now - lastFlush >= std::chrono::milliseconds(opt_.flushIntervalMs)))
+            {
+                flushBlock();
+                lastFlush = now;
+            }
+            if (!live)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    void Historian::encode(const uint8_t *rec, int64_t ts, int32_t wkc)
+    {
+        if (blkTs_.empty())
+            std::fill(prev_.begin(), prev_.end(), 0);
+        for (uint32_t i = 0; i < recordSize_; i++)
+            diff_[i] = rec[i] ^ prev_[i];
+        std::memcpy(prev_.data(), rec, recordSize_);
+
+        uint32_t pos = 0;
+        while (pos < recordSize_)
+        {
+            uint32_t zeros = 0;
+            while (pos + zeros < recordSize_ && zeros < kMaxToken && diff_[pos + zeros] == 0)
+                zeros++;
+            uint32_t litStart = pos + zeros;
+            uint32_t lit = 0;
+            if (zeros < kMaxToken)
+            {
+                while (litStart + lit < recordSize_ && lit < kMaxToken)
+                {
+                    uint32_t i = litStart + lit;
+                    if (diff_[i] == 0)
+                    {
+                        uint32_t run = 0;
+                        while (i + run < recordSize_ && run < kMinZeroRun && diff_[i + run] == 0)
+                            run++;
+                        if (run >= kMinZeroRun || i + run == recordSize_)
+                            break;
+                    }
+                    lit++;
+                }
+            }
+            uint16_t z16 = static_cast<uint16_t>(zeros);
+            uint16_t l16 = static_cast<uint16_t>(lit);
+            size_t at = blkData_.size();
+            blkData_.resize(at + 4 + lit);
+            std::memcpy(&blkData_[at], &z16, 2);
+            std::memcpy(&blkData_[at + 2], &l16, 2);
+            if (lit)
+                std::memcpy(&blkData_[at + 4], &diff_[litStart], lit);
+            pos = litStart + lit;
+        }
+        blkTs_.push_back(ts);
+        blkWkc_.push_back(wkc);
+    }
+
+    bool Historian::flushBlock()
+    {
+        if (blkTs_.empty())
+            return true;
+        uint32_t count = static_cast<uint32_t>(blkTs_.size());
+        size_t payload = count * (sizeof(int64_t) + sizeof(int32_t)) + blkData_.size();
+        size_t total = sizeof(BlockHeader) + payload;
+        if (!seg_ || seg_->header->dataEnd + total > seg_->file.size())
+        {
+            closeSegment();
+            segmentSeq_++;
+            if (!openSegment())
+            {
+                // Disk trouble: drop the block rather than stall the ring.
+                dropped_ += count;
+                blkTs_.clear();
+                blkWkc_.clear();
+                blkData_.clear();
+                return false;
+            }
+        }
+        SegmentHeader *sh = seg_->header;
+        uint8_t *p = seg_->file.data() + sh->dataEnd;
+        BlockHeader bh;
+        bh.magic = kBlockMagic;
+        bh.count = count;
+        bh.firstTs = blkTs_.front();
+        bh.lastTs = blkTs_.back();
+        bh.payloadBytes = static_cast<uint32_t>(payload);
+        bh.reserved = 0;
+        std::memcpy(p, &bh, sizeof(bh));
+        p += sizeof(bh);
+        std::memcpy(p, blkTs_.data(), count * sizeof(int64_t));
+        p += count * sizeof(int64_t);
+        std::memcpy(p, blkWkc_.data(), count * sizeof(int32_t));
+        p += count * sizeof(int32_t);
+        std::memcpy(p, blkData_.data(), blkData_.size());
+
+        // Publish the block only once its bytes are in place.
+        std::atomic_thread_fence(std::memory_order_release);
+        if (sh->records == 0)
+            sh->firstTs = bh.firstTs;
+        sh->lastTs = bh.lastTs;
+        sh->records += count;
+        sh->dataEnd += total;
+
+        recorded_ += count;
+        blocks_++;
+        bytesWritten_ += total;
+        blkTs_.clear();
+        blkWkc_.clear();
+        blkData_.clear();
+        return true;
+    }
+
+    bool Historian::openSegment()
+    {
+        std::unique_ptr<Segment> seg(new Segment());
+        std::string path = (fs::path(opt_.dir) / segmentName(segmentSeq_)).string();
+        if (!seg->file.open(path, opt_.segmentBytes, true))
+            return false;
+        seg->header = reinterpret_cast<SegmentHeader *>(seg->file.data());
+        std::memset(seg->header, 0, sizeof(SegmentHeader));
+        std::memcpy(seg->header->magic, kSegmentMagic, sizeof(kSegmentMagic));
+        seg->header->version = kVersion;
+        seg->header->recordSize = recordSize_;
+        seg->header->dataEnd = sizeof(SegmentHeader);
+        sampleClocks(seg->header->wallBaseNs, seg->header->steadyBaseNs);
+        seg_ = seg.release();
+        pruneSegments();
+        return true;
+    }
+
+    void Historian::closeSegment()
+    {
+        if (!seg_)
+            return;
+        uint64_t used = seg_->header->dataEnd;
+        seg_->file.unmap(used);
+        delete seg_;
+        seg_ = nullptr;
+    }
+
+    void Historian::pruneSegments()
+    {
+        std::vector<fs::path> segs = listSegments(opt_.dir);
+        std::error_code ec;
+        for (size_t i = 0; i + opt_.maxSegments < segs.size(); i++)
+            fs::remove(segs[i], ec);
+    }
+
+    bool Historian::read(const std::string &dir, int64_t fromNs, int64_t toNs, size_t maxRecords, Result &out, std::string &err)
+    {
+        out = Result();
+        std::vector<uint8_t> rec;
+        // Segments are visited in creation order. Their wall-clock ranges are
+        // compared one by one: a wall clock step between two recordings may
+        // leave them out of order, so no segment ends the scan.
+        for (const fs::path &path : listSegments(dir))
+        {
+            MappedFile file;
+            if (!file.open(path.string(), 0, false) || file.size() < sizeof(SegmentHeader))
+                continue;
+            SegmentHeader sh;
+            std::memcpy(&sh, file.data(), sizeof(sh));
+            if (std::memcmp(sh.magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0 || sh.version == 0 || sh.version > kVersion)
+                continue;
+            // Within a version 2 segment timestamps never decrease.
+            bool monotonic = sh.version >= 2;
+            int64_t offset = sh.wallBaseNs - sh.steadyBaseNs;
+            if (sh.records == 0 || sh.lastTs + offset < fromNs || sh.firstTs + offset > toNs)
+                continue;
+            if (out.recordSize == 0)
+                out.recordSize = sh.recordSize;
+            else if (out.recordSize != sh.recordSize)
+            {
+                err = "segments with different record sizes in " + dir;
+                return false;
+            }
+            rec.resize(sh.recordSize);
+            uint64_t end = std::min<uint64_t>(sh.dataEnd, file.size());
+            uint64_t off = sizeof(SegmentHeader);
+            bool past = false;
+            while (!past && off + sizeof(BlockHeader) <= end)
+            {
+                BlockHeader bh;
+                std::memcpy(&bh, file.data() + off, sizeof(bh));
+                uint64_t next = off + sizeof(BlockHeader) + bh.payloadBytes;
+                if (bh.magic != kBlockMagic || next > end)
+                    break;
+                if (monotonic && bh.firstTs + offset > toNs)
+                    break;
+                // The timestamp and wkc columns must fit in the payload; a block
+                // with a damaged count is skipped, the next one is still valid.
+                uint64_t columns = static_cast<uint64_t>(bh.count) * (sizeof(int64_t) + sizeof(int32_t));
+                if (columns > bh.payloadBytes)
+                {
+                    off = next;
+                    continue;
+                }
+                if (!monotonic || bh.lastTs + offset >= fromNs)
+                {
+                    const uint8_t *p = file.data() + off + sizeof(BlockHeader);
+                    const uint8_t *pend = file.data() + next;
+                    const uint8_t *tsCol = p;
+                    const uint8_t *wkcCol = p + bh.count * sizeof(int64_t);
+                    p = wkcCol + bh.count * sizeof(int32_t);
+                    std::fill(rec.begin(), rec.end(), 0);
+                    for (uint32_t i = 0; i < bh.count; i++)
+                    {
+                        if (!decodeRecord(p, pend, rec.data(), sh.recordSize))
+                            break;
+                        int64_t ts;
+                        std::memcpy(&ts, tsCol + i * sizeof(int64_t), sizeof(ts));
+                        ts += offset;
+                        if (ts < fromNs)
+                            continue;
+                        if (ts > toNs)
+                        {
+                            past = monotonic;
+                            if (past)
+                                break;
+                            continue;
+                        }
+                        int32_t wkc;
+                        std::memcpy(&wkc, wkcCol + i * sizeof(int32_t), sizeof(wkc));
+                        out.timestamps.push_back(ts);
+                        out.wkc.push_back(wkc);
+                        out.data.insert(out.data.end(), rec.begin(), rec.end());
+                        if (maxRecords && out.timestamps.size() >= maxRecords)
+                            return true;
+                    }
+                }
+                off = next;
+            }
+        }
+        return true;
+    }
+
+} // namespace soemnode
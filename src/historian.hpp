@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace soemnode
+{
+
+    // Append-only process data recorder.
+    //
+    // The cyclic side calls record() after each exchange; it only copies the
+    // selected bytes of the process image into a preallocated single-producer
+    // ring. A writer thread drains the ring, encodes blocks and appends them
+    // to memory-mapped segment files that are rotated once full.
+    //
+    // Timestamps are taken from steady_clock, so ordering and seeking never
+    // see the wall clock step; each segment stores the wall-clock time of a
+    // steady reference point, which read() uses to return Unix time.
+    //
+    // Segment layout (little endian):
+    //   SegmentHeader (64 bytes)
+    //   Block*: BlockHeader (32 bytes)
+    //           int64 timestamps[count]   steady_clock ns
+    //           int32 wkc[count]
+    //           data column: per record, the XOR against the previous record
+    //           of the block (the first one against zeros) as tokens
+    //           { uint16 zeroRun; uint16 literalLen; uint8 literal[literalLen] }
+    //           until recordSize bytes are covered.
+    // Blocks are self-contained so a reader can skip straight to a time range
+    // using the block and segment timestamps.
+    class Historian
+    {
+    public:
+        struct Range
+        {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        struct Options
+        {
+            std::string dir;
+            std::vector<Range> ranges;
+            uint64_t segmentBytes = 64ull * 1024 * 1024;
+            uint32_t maxSegments = 16;
+            uint32_t blockRecords = 1000;
+            uint32_t ringRecords = 8192;
+            uint32_t flushIntervalMs = 100;
+        };
+
+        struct Stats
+        {
+            uint64_t recorded;
+            uint64_t dropped;
+            uint64_t blocks;
+            uint64_t bytesWritten;
+            uint64_t segment;
+        };
+
+        struct Result
+        {
+            uint32_t recordSize = 0;
+            std::vector<int64_t> timestamps;
+            std::vector<int32_t> wkc;
+            std::vector<uint8_t> data;
+        };
+
+        Historian() = default;
+        ~Historian();
+        Historian(const Historian &) = delete;
+        Historian &operator=(const Historian &) = delete;
+
+        // Opens the first segment and starts the writer thread. Returns false
+        // with err set if the directory or options are unusable.
+        bool start(const Options &opt, std::string &err);
+        void stop();
+
+        // Cyclic side: bounded memcpy, no syscalls, no locks. steadyNs is
+        // steady_clock time since its epoch.
+        void record(int64_t steadyNs, int32_t wkc, const uint8_t *image);
+
+        Stats stats() const;
+        uint32_t recordSize() const { return recordSize_; }
+
+        // Reads every record with from <= timestamp <= to from the segments in
+        // dir. Bounds and returned timestamps are ns since the Unix epoch.
+        static bool read(const std::string &dir, int64_t fromNs, int64_t toNs, size_t maxRecords, Result &out, std::string &err);
+
+    private:
+        struct Segment;
+
+        void writerLoop();
+        void encode(const uint8_t *rec, int64_t ts, int32_t wkc);
+        bool flushBlock();
+        bool openSegment();
+        void closeSegment();
+        void pruneSegments();
+
+        Options opt_;
+        uint32_t recordSize_ = 0;
+        size_t slotStride_ = 0;
+        std::vector<uint8_t> ring_;
+        std::atomic<uint64_t> head_{0};
+        std::atomic<uint64_t> tail_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<uint64_t> recorded_{0};
+        std::atomic<uint64_t> blocks_{0};
+        std::atomic<uint64_t> bytesWritten_{0};
+        std::atomic<uint64_t> segmentSeq_{0};
+        std::atomic<bool> running_{false};
+        std::thread writer_;
+
+        // Writer thread state
+        std::vector<int64_t> blkTs_;
+        std::vector<int32_t> blkWkc_;
+        std::vector<uint8_t> blkData_;
+        std::vector<uint8_t> prev_;
+        std::vector<uint8_t> diff_;
+        Segment *seg_ = nullptr;
+    };
+
+} // namespace soemnode
@@ -14,6 +14,10 @@ try {
   native = require('../build/Release/soem_addon.node');
 }
 
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+
 /**
  * Représentation d'une interface réseau retournée par `SoemMaster.listInterfaces()`.
  */
@@ -24,6 +28,371 @@ export interface NetworkInterface {
   description: string;
 }
 
+/** Identité EtherCAT d'un esclave (lue dans l'EEPROM/SII lors de `configInit()`). */
+export interface SlaveIdentity {
+  vendorId: number;
+  productCode: number;
+  revision: number;
+}
+
+/** Sous-entrée d'un objet du dictionnaire CoE. */
+export interface ODEntry {
+  subIndex: number;
+  /** Type de donnée CoE (ex: 0x0007 = UNSIGNED32) */
+  dataType: number;
+  bitLength: number;
+  /** Masque d'accès CoE (bits lecture/écriture par état, mappable en PDO, ...) */
+  access: number;
+  name: string;
+}
+
+/** Objet du dictionnaire CoE (VAR, ARRAY ou RECORD). */
+export interface ODObject {
+  index: number;
+  dataType: number;
+  /** Code objet CoE: 7 = VAR, 8 = ARRAY, 9 = RECORD */
+  objectCode: number;
+  maxSub: number;
+  name: string;
+  entries: ODEntry[];
+}
+
+/** Dictionnaire d'objets d'un esclave, tel que retourné par `readObjectDictionary()`. */
+export interface ObjectDictionary extends SlaveIdentity {
+  objects: ODObject[];
+  /**
+   * Présent quand une description d'objet ou d'entrée n'a pas pu être lue: les objets
+   * concernés sont omis ou sans entrées, et le résultat n'est pas mis en cache.
+   */
+  incomplete?: boolean;
+}
+
+export interface ReadObjectDictionaryOptions {
+  /**
+   * Répertoire du cache persistant (un fichier JSON par vendor/product/revision).
+   * Défaut: `$SOEM_OD_CACHE_DIR` ou `~/.cache/soem-node/od`. `null` désactive la persistance.
+   */
+  cacheDir?: string | null;
+  /** Ignore le cache et relit le dictionnaire sur l'esclave. */
+  refresh?: boolean;
+}
+
+/** Instrumentation de la redondance de câble (voir `initRedundant()`). */
+export interface RedundancyStatus {
+  /** true si le master a été ouvert avec `initRedundant()` */
+  enabled: boolean;
+  /** true si le dernier cycle a dû passer par le chemin redondant (anneau ouvert) */
+  lineBreak: boolean;
+  /** nombre de passages anneau fermé -> anneau ouvert */
+  lineBreaks: number;
+  /** cycles processdata observés */
+  cycles: number;
+  /** trames reçues sur le port primaire / secondaire */
+  primaryFrames: number;
+  secondaryFrames: number;
+  /** trames reçues sur aucun des deux ports */
+  lostFrames: number;
+  /** cycles au WKC incomplet lors de la dernière bascule (0 = bascule sans perte) */
+  lastFailoverCycles: number;
+  maxFailoverCycles: number;
+  /** durée (µs) entre le dernier cycle complet avant la coupure et le premier cycle complet après */
+  lastFailoverUs: number;
+  maxFailoverUs: number;
+}
+
+/**
+ * Index des champs écrits par `exchange()` dans le tableau de statut (Int32Array de longueur >= 4).
+ */
+export const ExchangeStatus = {
+  /** working counter reçu */
+  WKC: 0,
+  /** working counter attendu pour le groupe (outputsWKC * 2 + inputsWKC) */
+  EXPECTED_WKC: 1,
+  /** aller-retour (µs), de l'appel d'envoi à la fin de la réception: inclut la mise en trame et l'émission */
+  ROUNDTRIP_US: 2,
+  /** durée totale de l'appel, copies comprises (µs) */
+  EXCHANGE_US: 3,
+  /** longueur minimale du tableau de statut */
+  LENGTH: 4
+} as const;
+
+/**
+ * Disposition d'un enregistrement de diagnostic (24 octets, little endian) écrit par `drainDiagnostics()`.
+ * Lecture sans parsing: `view.getUint16(i * DiagnosticRecord.SIZE + DiagnosticRecord.SLAVE, true)`.
+ */
+export const DiagnosticRecord = {
+  /** int64: horodatage en ns depuis l'epoch Unix (`getBigInt64`) */
+  TIMESTAMP: 0,
+  /** uint16: esclave (0 = master) */
+  SLAVE: 8,
+  /** uint16: voir `DiagnosticType` */
+  TYPE: 10,
+  /** uint32: code d'abort SDO/SoE, code d'emergency, ou port ESC */
+  CODE: 12,
+  /** int32: index << 8 | subindex, registre d'erreur d'emergency, ou incrément d'un compteur ESC */
+  DETAIL: 16,
+  /** uint32: octets constructeur d'emergency, ou nouvelle valeur d'un compteur ESC */
+  AUX: 20,
+  SIZE: 24
+} as const;
+
+/** Types d'événements: valeurs `ec_err_type` de SOEM (< 0x100), puis compteurs ESC. */
+export const DiagnosticType = {
+  SDO_ERROR: 0,
+  EMERGENCY: 1,
+  PACKET_ERROR: 3,
+  SDOINFO_ERROR: 4,
+  FOE_ERROR: 5,
+  FOE_BUF2SMALL: 6,
+  FOE_PACKETNUMBER: 7,
+  SOE_ERROR: 8,
+  MBX_ERROR: 9,
+  FOE_FILE_NOTFOUND: 10,
+  EOE_INVALID_RX_DATA: 11,
+  ESC_RX_ERROR: 0x100,
+  ESC_INVALID_FRAME: 0x101,
+  ESC_FORWARDED_ERROR: 0x102,
+  ESC_PROCESSING_UNIT: 0x103,
+  ESC_PDI_ERROR: 0x104,
+  ESC_LOST_LINK: 0x105,
+  SLAVE_NO_RESPONSE: 0x110,
+  SLAVE_RESPONDING: 0x111
+} as const;
+
+export interface DiagnosticsOptions {
+  /** nombre d'enregistrements de l'anneau; les plus anciens sont écrasés (défaut 1024) */
+  capacity?: number;
+  /** période de lecture des compteurs d'erreur ESC, 0 pour désactiver (ms, défaut 1000) */
+  counterIntervalMs?: number;
+  /** esclaves lus par période, en round-robin (défaut 16) */
+  slavesPerPoll?: number;
+}
+
+export interface DiagnosticsStatus {
+  running: boolean;
+  capacity: number;
+  /** enregistrements en attente de `drainDiagnostics()` */
+  pending: number;
+  recorded: number;
+  /** enregistrements écrasés avant d'être lus */
+  overwritten: number;
+  counterPolls: number;
+}
+
+/** Tailles de l'image process d'un groupe après `configMapPDO()` / `configMapGroup()`. */
+export interface ProcessImageLayout {
+  outputsBytes: number;
+  inputsBytes: number;
+  expectedWkc: number;
+}
+
+/** Classe de priorité d'une requête acyclique: les files sont servies dans cet ordre. */
+export type MailboxPriority = 'high' | 'normal' | 'low';
+
+export interface MailboxRequestBase {
+  slave: number;
+  priority?: MailboxPriority;
+  /** timeout natif en µs (défaut EC_TIMEOUTRXM pour SDO/SoE, EC_TIMEOUTRET pour EEPROM/registres) */
+  timeout?: number;
+}
+
+/** Requête acyclique servie par l'ordonnanceur mailbox (voir `mailbox()`). */
+export type MailboxRequest =
+  | (MailboxRequestBase & { type: 'sdoRead'; index: number; subIndex: number; completeAccess?: boolean; maxSize?: number })
+  | (MailboxRequestBase & { type: 'sdoWrite'; index: number; subIndex: number; data: ArrayBufferView; completeAccess?: boolean })
+  | (MailboxRequestBase & { type: 'soeRead'; driveNo: number; elementFlags: number; idn: number; maxSize?: number })
+  | (MailboxRequestBase & { type: 'soeWrite'; driveNo: number; elementFlags: number; idn: number; data: ArrayBufferView })
+  | (MailboxRequestBase & { type: 'eepromRead'; address: number })
+  | (MailboxRequestBase & { type: 'eepromWrite'; address: number; value: number })
+  | (MailboxRequestBase & { type: 'registerRead'; address: number; length: number })
+  | (MailboxRequestBase & { type: 'registerWrite'; address: number; data: ArrayBufferView });
+
+/** Résultat d'une requête: Buffer (lectures, null si échec), number (eepromRead, null si échec), boolean (écritures). */
+export type MailboxResult<R extends MailboxRequest> =
+  R extends { type: 'sdoRead' | 'soeRead' | 'registerRead' } ? Buffer | null :
+  R extends { type: 'eepromRead' } ? number | null : boolean;
+
+/** Budget de l'ordonnanceur mailbox, partagé avec la boucle cyclique. */
+export interface MailboxSchedulerOptions {
+  /** période nominale du cycle processdata (µs, défaut 1000) */
+  periodUs?: number;
+  /**
+   * fenêtre acyclique par cycle, comptée depuis la fin de l'échange (µs, défaut 250). Une requête n'y
+   * démarre que si la fenêtre est ouverte; les accès registre y sont bornés, mais un transfert mailbox
+   * (SDO, SoE, EEPROM) attend la réponse de l'esclave jusqu'à son propre timeout (voir `overruns`).
+   */
+  budgetUs?: number;
+  /** nombre de requêtes démarrées par cycle (défaut 1) */
+  maxPerCycle?: number;
+  /** marge laissée libre avant le cycle suivant (µs, défaut 100) */
+  guardUs?: number;
+  /** sans cycle depuis ce délai, le bus est considéré inactif et la file est servie en continu (µs, défaut 10000) */
+  idleAfterUs?: number;
+}
+
+export interface MailboxStatus {
+  /** requêtes en attente par classe [high, normal, low] */
+  queued: number[];
+  /** requêtes servies par classe [high, normal, low] */
+  served: number[];
+  cycles: number;
+  /** cycles dont le temps libre était inférieur à budget + marge */
+  skippedCycles: number;
+  /** requêtes encore en cours à la fermeture de leur fenêtre */
+  overruns: number;
+  /** plus grand dépassement de fenêtre observé (µs) */
+  maxOverrunUs: number;
+}
+
+/** Esclave vu par `scanTopology()` à une position de la chaîne. */
+export interface TopologySlave {
+  /** position dans la chaîne (1 = premier esclave) */
+  position: number;
+  /** index de l'esclave configuré correspondant, 0 si nouvel esclave */
+  slave: number;
+  configadr: number;
+  aliasadr: number;
+  /** identité (absente pour un nouvel esclave sans `identify: true`) */
+  vendorId?: number;
+  productCode?: number;
+  revision?: number;
+  /** registre AL status (état + bit d'erreur) */
+  state: number;
+  ALstatuscode: number;
+  /** registre DL status brut (0x0110) */
+  dlStatus: number;
+  /** ports avec lien physique (bit n = port n) */
+  linkPorts: number;
+  /** ports ouverts vers un esclave voisin (bit n = port n) */
+  openPorts: number;
+}
+
+export interface TopologyScanOptions {
+  /**
+   * lit l'identité SII des nouveaux esclaves (défaut false). Écrit pour cela leurs registres
+   * d'interface EEPROM (0x0502-0x0505) et en prend le contrôle côté master.
+   */
+  identify?: boolean;
+}
+
+export interface TopologyScan {
+  /** esclaves présents sur le bus */
+  slaveCount: number;
+  /** esclaves configurés par `configInit` / `configNewSlaves` */
+  configuredCount: number;
+  slaves: TopologySlave[];
+  /** positions des esclaves inconnus */
+  added: number[];
+  /** index des esclaves configurés qui ne répondent plus */
+  removed: number[];
+}
+
+export interface NewSlavesResult {
+  added: number;
+  group: number;
+  firstSlave?: number;
+  lastSlave?: number;
+  /** adresse logique de la nouvelle image, après les images existantes */
+  logicalStart?: number;
+  ioMapBytes?: number;
+  outputsBytes?: number;
+  inputsBytes?: number;
+  expectedWkc?: number;
+  /** configuration interrompue avant le dernier esclave, ou esclaves restés hors de PRE-OP / SAFE-OP */
+  error?: string;
+}
+
+/** Plage d'octets de l'image du groupe (sorties puis entrées) à historiser. */
+export interface HistorianRange {
+  offset: number;
+  length: number;
+}
+
+export interface HistorianOptions {
+  /** répertoire des segments `seg-*.hist` (créé si besoin) */
+  dir: string;
+  /** groupe processdata enregistré (défaut 0) */
+  group?: number;
+  /** plages enregistrées; défaut: toute l'image du groupe */
+  ranges?: HistorianRange[];
+  /** taille d'un segment mappé en mémoire (octets, défaut 64 Mio) */
+  segmentBytes?: number;
+  /** segments conservés, les plus anciens sont supprimés (défaut 16) */
+  maxSegments?: number;
+  /** enregistrements par bloc compressé (défaut 1000) */
+  blockRecords?: number;
+  /** capacité de l'anneau entre le cycle et le thread d'écriture (défaut 8192) */
+  ringRecords?: number;
+  /** délai max avant écriture d'un bloc incomplet (ms, défaut 100) */
+  flushIntervalMs?: number;
+}
+
+export interface HistorianStatus {
+  running: boolean;
+  /** octets par enregistrement (somme des plages) */
+  recordSize: number;
+  /** enregistrements écrits dans les segments */
+  recorded: number;
+  /** enregistrements perdus (anneau plein ou erreur disque) */
+  dropped: number;
+  blocks: number;
+  bytesWritten: number;
+  /** numéro du segment courant */
+  segment: number;
+}
+
+export interface HistoryRecords {
+  recordSize: number;
+  /**
+   * horodatages en ns depuis l'epoch Unix. L'enregistrement se fait sur une horloge monotone; chaque
+   * segment mémorise l'heure murale de sa création, qui sert à la conversion.
+   */
+  timestamps: BigInt64Array;
+  wkc: Int32Array;
+  /** enregistrements concaténés, `recordSize` octets chacun */
+  data: Buffer;
+}
+
+/** Délais du binding NodeSoemMaster, en µs (défauts historiques: 5000 et 1000). */
+export interface NodeSoemMasterTimeouts {
+  /** délai de `receiveProcessdata()` */
+  receive?: number;
+  /** délai par défaut de `statecheck()` */
+  statecheck?: number;
+}
+
+const MAILBOX_PRIORITY: Record<MailboxPriority, number> = { high: 0, normal: 1, low: 2 };
+
+function defaultOdCacheDir(): string {
+  return process.env.SOEM_OD_CACHE_DIR || path.join(os.homedir(), '.cache', 'soem-node', 'od');
+}
+
+function odCacheKey(id: SlaveIdentity): string {
+  const hex = (v: number) => (v >>> 0).toString(16).padStart(8, '0');
+  return `${hex(id.vendorId)}-${hex(id.productCode)}-${hex(id.revision)}`;
+}
+
+function loadOdCache(dir: string, key: string): ObjectDictionary | null {
+  try {
+    return JSON.parse(fs.readFileSync(path.join(dir, `${key}.json`), 'utf8')) as ObjectDictionary;
+  } catch {
+    return null;
+  }
+}
+
+function storeOdCache(dir: string, key: string, od: ObjectDictionary): void {
+  // Le cache est une optimisation: une erreur d'écriture ne doit pas faire échouer la lecture.
+  try {
+    fs.mkdirSync(dir, { recursive: true });
+    const file = path.join(dir, `${key}.json`);
+    const tmp = `${file}.${process.pid}.tmp`;
+    fs.writeFileSync(tmp, JSON.stringify(od));
+    fs.renameSync(tmp, file);
+  } catch {
+    /* ignore */
+  }
+}
+
 /**
  * Wrapper TypeScript autour du binding natif SOEM (N-API).
  *
@@ -43,6 +412,10 @@ export interface NetworkInterface {
  */
 export class SoemMaster {
   private _m: any;
+  /** Dictionnaires connus ou en cours de lecture, partagés entre masters (clé: vendor/product/revision). */
+  private static _odCache = new Map<string, Promise<ObjectDictionary>>();
+  /** Sérialise les scans de dictionnaire d'un même master (une seule transaction mailbox à la fois). */
+  private _odQueue: Promise<unknown> = Promise.resolve();
 
   /**
    * Crée une instance du Master SOEM en se liant à une interface réseau.
@@ -87,9 +460,26 @@ export class SoemMaster {
    * @param index Index de l'objet SDO (ex: 0x1000).
    * @param sub Sous-index de l'objet SDO (ex: 0).
   * @param ca optional Complete Access flag (true = Complete Access)
+  * @param maxSize taille maximale attendue en octets (défaut 64 Ko); les objets plus grands
+  *   qu'une mailbox sont lus en transfert segmenté.
   * @returns Buffer contenant les octets lus, ou null/undefined si la lecture a échoué.
   */
-  sdoRead(slave: number, index: number, sub: number, ca?: boolean): Buffer | null { return this._m.sdoRead(slave, index, sub, ca); }
+  sdoRead(slave: number, index: number, sub: number, ca?: boolean, maxSize?: number): Buffer | null {
+    if (maxSize === undefined) return this._m.sdoRead(slave, index, sub, ca);
+    return this._m.sdoRead(slave, index, sub, ca, maxSize);
+  }
+
+  /**
+   * Lit un SDO directement dans un buffer fourni par l'appelant (aucune allocation).
+   * Les objets de grande taille sont lus en transfert segmenté.
+   * @param target Buffer / TypedArray de destination, réutilisable d'un appel à l'autre.
+   * @param offset position d'écriture dans `target` (défaut 0); la place disponible est
+   *   `target.byteLength - offset`.
+   * @returns nombre d'octets écrits, ou -1 si la lecture a échoué (ou si la place est insuffisante).
+   */
+  sdoReadInto(slave: number, index: number, sub: number, target: ArrayBufferView, offset: number = 0, ca: boolean = false): number {
+    return this._m.sdoReadInto(slave, index, sub, target, offset, ca);
+  }
 
   /**
    * Écrit un SDO sur un esclave.
@@ -111,9 +501,10 @@ export class SoemMaster {
 
   /**
    * Reçoit les données process (processdata) depuis le réseau EtherCAT pour le cycle courant.
+   * @param timeout délai d'attente en µs (défaut EC_TIMEOUTRET, 2000 µs)
    * @returns code WKC (working counter) ou nombre d'octets reçus selon le binding.
    */
-  receiveProcessdata(): number { return this._m.receiveProcessdata(); }
+  receiveProcessdata(timeout?: number): number { return this._m.receiveProcessdata(timeout); }
 
   /**
    * Ferme le master et libère les ressources (sockets/bruts, handles natifs).
@@ -155,13 +546,196 @@ export class SoemMaster {
    * Retourne un tableau décrivant les esclaves détectés (name, state, outputs, inputs, ...).
    */
   getSlaves(): any[] { return this._m.getSlaves(); }
+
+  /**
+   * Inventaire rapide du bus par lectures broadcast / auto-incrément de registres, sans configInit:
+   * les esclaves en OP ne sont pas perturbés. L'identité des esclaves connus vient de la configuration;
+   * celle des nouveaux n'est lue dans leur SII qu'avec `identify: true`, ce qui écrit leurs registres
+   * d'interface EEPROM.
+   * @returns null si le master n'est pas ouvert ou si aucune trame n'est revenue.
+   */
+  scanTopology(options?: TopologyScanOptions): TopologyScan | null { return this._m.scanTopology(options); }
+
+  /**
+   * Configure uniquement les esclaves apparus en fin de chaîne (ex: changeur d'outil): adresse,
+   * mailbox, PRE-OP, mapping dans le groupe `group` placé après l'image existante, puis SAFE-OP.
+   * Les esclaves déjà configurés restent en OP et leur WKC attendu ne change pas. Échangez ensuite
+   * le nouveau groupe avec `exchange(..., group)` puis passez ses esclaves en OP avec `writeState`.
+   * S'exécute dans un thread de travail (lectures SII, mapping, changements d'état) sans bloquer la boucle JS.
+   * Rejette si des esclaves configurés manquent ou ont changé de position (un `configInit` complet est alors requis),
+   * si le groupe est déjà mappé, si le master n'est pas ouvert ou s'il est fermé pendant la configuration.
+   * Les DC des nouveaux esclaves ne sont pas configurées.
+   * @param group groupe processdata dédié aux nouveaux esclaves (défaut 1)
+   */
+  configNewSlaves(group: number = 1): Promise<NewSlavesResult> { return this._m.configNewSlaves(group); }
+
+  /**
+   * Identité (vendor / product / revision) d'un esclave configuré, ou null si l'index est invalide.
+   */
+  slaveIdentity(slave: number): SlaveIdentity | null { return this._m.slaveIdentity(slave); }
+
+  /**
+   * Lit le dictionnaire d'objets CoE d'un esclave via les services SDO Information
+   * (liste OD, description des objets et des entrées), hors du thread JS.
+   *
+   * Le résultat est mis en cache par vendor/product/revision, en mémoire et sur disque:
+   * parcourir 200 variateurs identiques ne coûte qu'un seul scan. Les lectures concurrentes
+   * d'esclaves identiques partagent le même scan. L'objet retourné est partagé: ne pas le modifier.
+   * @returns Promise résolue avec le dictionnaire, rejetée si l'esclave ne supporte pas SDO Info.
+   */
+  readObjectDictionary(slave: number, options: ReadObjectDictionaryOptions = {}): Promise<ObjectDictionary> {
+    const id: SlaveIdentity | null = this._m.slaveIdentity(slave);
+    if (!id || (id.vendorId === 0 && id.productCode === 0)) return this._scanObjectDictionary(slave);
+    const cacheDir = options.cacheDir === undefined ? defaultOdCacheDir() : options.cacheDir;
+    const key = odCacheKey(id);
+    if (!options.refresh) {
+      const known = SoemMaster._odCache.get(key);
+      if (known) return known;
+      const stored = cacheDir ? loadOdCache(cacheDir, key) : null;
+      if (stored) {
+        const p = Promise.resolve(stored);
+        SoemMaster._odCache.set(key, p);
+        return p;
+      }
+    }
+    const scan = this._scanObjectDictionary(slave).then((od) => {
+      if (od.incomplete) {
+        // Un scan partiel ne doit pas masquer le dictionnaire complet au prochain appel.
+        if (SoemMaster._odCache.get(key) === scan) SoemMaster._odCache.delete(key);
+      } else if (cacheDir) {
+        storeOdCache(cacheDir, key, od);
+      }
+      return od;
+    });
+    SoemMaster._odCache.set(key, scan);
+    scan.catch(() => {
+      if (SoemMaster._odCache.get(key) === scan) SoemMaster._odCache.delete(key);
+    });
+    return scan;
+  }
+
+  /**
+   * Vide le cache mémoire des dictionnaires d'objets (le cache disque est conservé).
+   */
+  static clearObjectDictionaryCache(): void { SoemMaster._odCache.clear(); }
+
+  private _scanObjectDictionary(slave: number): Promise<ObjectDictionary> {
+    const run = this._odQueue.then(() => this._m.readObjectDictionary(slave) as Promise<ObjectDictionary>);
+    this._odQueue = run.catch(() => undefined);
+    return run;
+  }
+
+  /**
+   * Ouvre le master en mode redondance de câble (anneau) sur deux interfaces.
+   * L'état du port secondaire appartient à l'instance et reste valide pendant toute la boucle cyclique.
+   */
   initRedundant(if1: string, if2: string): boolean { return this._m.initRedundant(if1, if2); }
+  /**
+   * Compteurs de redondance mis à jour à chaque `receiveProcessdata*()`: détection de coupure,
+   * trames par port et latence de bascule mesurée.
+   */
+  redundancyStatus(): RedundancyStatus { return this._m.redundancyStatus(); }
   configMapGroup(group?: number): Buffer | null { return this._m.configMapGroup(group); }
   sendProcessdataGroup(group?: number): number { return this._m.sendProcessdataGroup(group); }
   receiveProcessdataGroup(group?: number, timeout?: number): number { return this._m.receiveProcessdataGroup(group, timeout); }
+
+  /**
+   * Cycle processdata complet en une seule transition N-API: copie `outputs` dans l'IOmap du groupe,
+   * envoie/reçoit avec le timeout demandé, copie les entrées dans `inputs`, puis écrit WKC et temps
+   * dans `status` (voir `ExchangeStatus`). Aucun objet JS n'est alloué: réutilisez les mêmes vues à chaque cycle.
+   * @param outputs image des sorties à envoyer (null pour laisser l'IOmap inchangé)
+   * @param inputs destination des entrées reçues (null pour ne pas copier)
+   * @param status Int32Array préalloué d'au moins `ExchangeStatus.LENGTH` éléments
+   * @param group groupe processdata (défaut 0)
+   * @param timeout timeout de réception en µs (défaut EC_TIMEOUTRET)
+   * @throws TypeError si `status` n'est pas un Int32Array d'au moins 4 éléments ou si `outputs` / `inputs` ne sont
+   *   ni une vue binaire ni null, RangeError si le groupe est invalide
+   */
+  exchange(outputs: ArrayBufferView | null, inputs: ArrayBufferView | null, status: Int32Array, group: number = 0, timeout?: number): void {
+    this._m.exchange(outputs, inputs, status, group, timeout);
+  }
+
+  /**
+   * Tailles des sorties/entrées du groupe, pour dimensionner les vues passées à `exchange()`.
+   */
+  processImageLayout(group: number = 0): ProcessImageLayout | null { return this._m.processImageLayout(group); }
   mbxHandler(group?: number, limit?: number): number { return this._m.mbxHandler(group, limit); }
-  elist2string(): string { return this._m.elist2string(); }
-  SoEread(slave: number, driveNo: number, elementflags: number, idn: number): Buffer | null { return this._m.SoEread(slave, driveNo, elementflags, idn); }
+
+  /**
+   * Configure le budget de l'ordonnanceur acyclique. Les requêtes de `mailbox()` ne démarrent que
+   * dans le temps libre qui suit chaque `exchange()` / `receiveProcessdata*()`, dans la limite de
+   * `budgetUs` et `maxPerCycle`. Un transfert mailbox peut dépasser la fenêtre en attendant la réponse
+   * de l'esclave: voir `overruns` dans `mailboxStatus()`.
+   */
+  configureMailbox(options: MailboxSchedulerOptions): void { this._m.configureMailbox(options); }
+
+  /**
+   * Met en file une requête acyclique (SDO, SoE, EEPROM, registre ESC) exécutée par un thread natif
+   * dédié, hors du thread JS. Les classes de priorité `high` > `normal` > `low` sont servies dans l'ordre.
+   * Les appels synchrones (`sdoRead`, ...) sont sérialisés avec la file et attendent la requête en cours.
+   * @returns Promise rejetée si `close()` est appelé avant que la requête ne démarre.
+   */
+  mailbox<R extends MailboxRequest>(request: R): Promise<MailboxResult<R>> {
+    return this._m.mailboxSubmit({ ...request, priority: MAILBOX_PRIORITY[request.priority ?? 'normal'] });
+  }
+
+  /** État des files de l'ordonnanceur acyclique. */
+  mailboxStatus(): MailboxStatus { return this._m.mailboxStatus(); }
+
+  /**
+   * Démarre l'historisation du groupe: après chaque `exchange()` / `receiveProcessdata*()`, les plages
+   * choisies sont copiées dans un anneau préalloué (aucun appel système dans le cycle). Un thread natif
+   * compresse les enregistrements par blocs (XOR avec le précédent + RLE) et les ajoute à des segments
+   * mappés en mémoire, avec rotation et rétention.
+   * @returns false si le master n'est pas ouvert ou si le groupe n'a pas d'image; jette si les options sont invalides.
+   */
+  startHistorian(options: HistorianOptions): boolean { return this._m.startHistorian(options); }
+
+  /** Arrête l'historisation après écriture du dernier bloc. */
+  stopHistorian(): void { this._m.stopHistorian(); }
+
+  historianStatus(): HistorianStatus { return this._m.historianStatus(); }
+
+  /**
+   * Relit les enregistrements d'un répertoire d'historique entre `from` et `to` inclus, dans un thread
+   * de travail (le décodage de longues plages ne bloque pas la boucle JS).
+   * Les bornes sont des ns (bigint) ou des ms depuis l'epoch (number, ex: `Date.now()`).
+   */
+  static readHistory(dir: string, from?: bigint | number, to?: bigint | number, maxRecords?: number): Promise<HistoryRecords> {
+    return native.Master.readHistory(dir, from, to, maxRecords);
+  }
+  /**
+   * Liste d'erreurs SOEM formatée, ou null si une transaction mailbox est en cours.
+   * Préférez `drainDiagnostics()` pour une surveillance continue.
+   */
+  elist2string(): string | null { return this._m.elist2string(); }
+
+  /**
+   * Configure l'anneau de diagnostic natif: erreurs SOEM (SDO, emergency, mailbox, ...) relevées à chaque
+   * cycle, et compteurs d'erreur ESC (0x0300-0x0313) lus par lots par un thread natif. Seules les
+   * augmentations de compteurs produisent un événement.
+   */
+  configureDiagnostics(options: DiagnosticsOptions): void { this._m.configureDiagnostics(options); }
+
+  /**
+   * Copie les événements en attente dans `target` (enregistrements de `DiagnosticRecord.SIZE` octets,
+   * du plus ancien au plus récent) et les retire de l'anneau. Aucune chaîne ni objet n'est créé.
+   * @returns nombre d'enregistrements écrits, ou -1 si le master n'est pas ouvert ou si `target` n'est pas une vue binaire.
+   */
+  drainDiagnostics(target: ArrayBufferView): number { return this._m.drainDiagnostics(target); }
+
+  diagnosticsStatus(): DiagnosticsStatus { return this._m.diagnosticsStatus(); }
+  SoEread(slave: number, driveNo: number, elementflags: number, idn: number, maxSize?: number): Buffer | null {
+    if (maxSize === undefined) return this._m.SoEread(slave, driveNo, elementflags, idn);
+    return this._m.SoEread(slave, driveNo, elementflags, idn, maxSize);
+  }
+  /**
+   * Variante de `SoEread` écrivant dans un buffer fourni par l'appelant à partir de `offset`.
+   * @returns nombre d'octets écrits, ou -1 en cas d'échec.
+   */
+  SoEreadInto(slave: number, driveNo: number, elementflags: number, idn: number, target: ArrayBufferView, offset: number = 0): number {
+    return this._m.SoEreadInto(slave, driveNo, elementflags, idn, target, offset);
+  }
   SoEwrite(slave: number, driveNo: number, elementflags: number, idn: number, data: Buffer): boolean { return this._m.SoEwrite(slave, driveNo, elementflags, idn, data); }
   readeeprom(slave: number, eeproma: number, timeout?: number): number { return this._m.readeeprom(slave, eeproma, timeout); }
   writeeeprom(slave: number, eeproma: number, data: number, timeout?: number): number { return this._m.writeeeprom(slave, eeproma, data, timeout); }
@@ -181,3 +755,43 @@ export class SoemMaster {
     return native.Master.listInterfaces();
   }
 }
+
+/**
+ * API historique node-soem (`NodeSoemMaster`), conservée pour les anciennes applications.
+ *
+ * Couche de compatibilité au-dessus du même moteur que `SoemMaster`: chaque instance possède
+ * son propre contexte SOEM et peut donc tourner à côté d'autres masters. Les méthodes acceptent
+ * un numéro de groupe optionnel (défaut 0); `getMap()` renvoie une vue sans copie dimensionnée
+ * sur l'image mappée du groupe.
+ */
+export class NodeSoemMaster {
+  private _m: any;
+
+  /**
+   * @param ifname interface réseau. Défaut: 'eth0'.
+   * @param timeouts délais en µs, modifiables ensuite via `setTimeouts()`.
+   */
+  constructor(ifname: string = 'eth0', timeouts?: NodeSoemMasterTimeouts) {
+    this._m = timeouts ? new native.NodeSoemMaster(ifname, timeouts) : new native.NodeSoemMaster(ifname);
+  }
+
+  init(): number { return this._m.init(); }
+  configInit(): number { return this._m.configInit(); }
+  /** @returns taille de l'image mappée du groupe, en octets */
+  configMap(group?: number): number { return this._m.configMap(group); }
+  configDC(): number { return this._m.configDC(); }
+  sendProcessdata(group?: number): number { return this._m.sendProcessdata(group); }
+  /** @param timeout délai en µs, sinon celui configuré (5000 par défaut) */
+  receiveProcessdata(timeout?: number, group?: number): number { return this._m.receiveProcessdata(timeout, group); }
+  writeState(slave: number, state: number): number { return this._m.writeState(slave, state); }
+  readState(): number { return this._m.readState(); }
+  statecheck(slave: number, state: number, timeout?: number): number { return this._m.statecheck(slave, state, timeout); }
+  getSlaves(): any[] { return this._m.getSlaves(); }
+  getInterfaceName(): string { return this._m.getInterfaceName(); }
+  /** Image process du groupe (sorties puis entrées), partagée avec SOEM sans copie. */
+  getMap(group?: number): ArrayBuffer { return this._m.getMap(group); }
+  /** @returns WKC attendu du groupe (outputsWKC * 2 + inputsWKC) */
+  getExpectedWC(group?: number): number { return this._m.getExpectedWC(group); }
+  setTimeouts(timeouts: NodeSoemMasterTimeouts): void { this._m.setTimeouts(timeouts); }
+  close(): void { this._m.close(); }
+}
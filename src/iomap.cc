@@ -0,0 +1,79 @@
+// Platform-specific includes
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#endif
+
+#include "iomap.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace soemnode
+{
+
+    namespace
+    {
+        // Sync manager types from the SII: 3 is process data outputs, 4 inputs.
+        constexpr uint8 kSMOutputs = 3;
+        constexpr uint8 kSMInputs = 4;
+
+        size_t bitsToBytes(size_t bits)
+        {
+            return (bits + 7) / 8;
+        }
+
+        void rebase(uint8 *&p, const uint8 *from, size_t bytes, uint8 *to)
+        {
+            uintptr_t at = reinterpret_cast<uintptr_t>(p);
+            uintptr_t start = reinterpret_cast<uintptr_t>(from);
+            if (p && at >= start && at < start + bytes)
+                p = to + (at - start);
+        }
+    } // namespace
+
+    size_t groupIOmapEstimate(const ecx_contextt *ctx, uint8 group)
+    {
+        size_t total = 0;
+        for (int s = 1; s <= ctx->slavecount; s++)
+        {
+            const ec_slavet &sl = ctx->slavelist[s];
+            if (group && sl.group != group)
+                continue;
+            size_t out = 0;
+            size_t in = 0;
+            for (int i = 0; i < EC_MAXSM; i++)
+            {
+                if (sl.SMtype[i] == kSMOutputs)
+                    out += sl.SM[i].SMlength;
+                else if (sl.SMtype[i] == kSMInputs)
+                    in += sl.SM[i].SMlength;
+            }
+            out = std::max(out, bitsToBytes(sl.Obits));
+            in = std::max(in, bitsToBytes(sl.Ibits));
+            // SOEM starts a byte-sized slave on a new byte: at most one byte
+            // of padding per direction.
+            total += out + in + 2;
+        }
+        return total;
+    }
+
+    void rebaseGroupIOmap(ecx_contextt *ctx, uint8 group, const uint8 *from, size_t bytes, uint8 *to)
+    {
+        ec_groupt &grp = ctx->grouplist[group];
+        rebase(grp.outputs, from, bytes, to);
+        rebase(grp.inputs, from, bytes, to);
+        for (int s = 1; s <= ctx->slavecount; s++)
+        {
+            ec_slavet &sl = ctx->slavelist[s];
+            if (group && sl.group != group)
+                continue;
+            rebase(sl.outputs, from, bytes, to);
+            rebase(sl.inputs, from, bytes, to);
+        }
+    }
+
+} // namespace soemnode
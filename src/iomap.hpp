@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+extern "C"
+{
+#include "ethercat.h"
+}
+
+namespace soemnode
+{
+
+    // Upper bound of the IOmap ecx_config_map_group needs for a group (0 is
+    // every slave), from what is known before mapping: the process data
+    // sync manager lengths read from the SII by ecx_config_init and the bits
+    // of a previous mapping. A PDO assignment changed over CoE before the
+    // map can still exceed it.
+    size_t groupIOmapEstimate(const ecx_contextt *ctx, uint8 group);
+
+    // Moves the group and slave pointers that SOEM laid out in
+    // [from, from + bytes) to the same offsets in to. Compared as integers:
+    // the old map may be smaller than the range the pointers were laid out for.
+    void rebaseGroupIOmap(ecx_contextt *ctx, uint8 group, const uint8 *from, size_t bytes, uint8 *to);
+
+} // namespace soemnode
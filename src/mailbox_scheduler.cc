@@ -0,0 +1,157 @@
+// Platform-specific includes
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#endif
+
+#include "mailbox_scheduler.hpp"
+
+namespace soemnode
+{
+
+    MailboxScheduler::MailboxScheduler(ecx_contextt *ctx, std::mutex &ctxLock, DoneFn done)
+        : ctx_(ctx), ctxLock_(ctxLock), done_(std::move(done))
+    {
+        thread_ = std::thread(&MailboxScheduler::loop, this);
+    }
+
+    MailboxScheduler::~MailboxScheduler()
+    {
+        stop();
+    }
+
+    void MailboxScheduler::configure(const Config &cfg)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        cfg_ = cfg;
+        if (cfg_.maxPerCycle == 0)
+            cfg_.maxPerCycle = 1;
+        cv_.notify_all();
+    }
+
+    MailboxScheduler::Config MailboxScheduler::config()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return cfg_;
+    }
+
+    MailboxScheduler::Stats MailboxScheduler::stats()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Stats s = stats_;
+        for (int p = 0; p < PRIO_COUNT; p++)
+            s.queued[p] = queues_[p].size();
+        return s;
+    }
+
+    void MailboxScheduler::submit(std::unique_ptr<Job> job)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        int p = job->priority;
+        if (p < 0 || p >= PRIO_COUNT)
+            p = PRIO_NORMAL;
+        queues_[p].push_back(std::move(job));
+        cv_.notify_all();
+    }
+
+    void MailboxScheduler::cycleDone(std::chrono::steady_clock::time_point cycleStart, std::chrono::steady_clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stats_.cycles++;
+        lastCycle_ = now;
+        auto period = std::chrono::microseconds(cfg_.periodUs);
+        auto guard = std::chrono::microseconds(cfg_.guardUs);
+        auto budget = std::chrono::microseconds(cfg_.budgetUs);
+        auto nextCycle = cycleStart + period;
+        if (now + budget + guard > nextCycle)
+        {
+            // Not enough idle time left in this period: keep the queue for later.
+            grants_ = 0;
+            stats_.skippedCycles++;
+            return;
+        }
+        grants_ = cfg_.maxPerCycle;
+        windowEnd_ = now + budget;
+        cv_.notify_all();
+    }
+
+    void MailboxScheduler::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (stopping_)
+                return;
+            stopping_ = true;
+            cv_.notify_all();
+        }
+        if (thread_.joinable())
+            thread_.join();
+        // Jobs that never ran are still completed so their owners are released.
+        for (int p = 0; p < PRIO_COUNT; p++)
+        {
+            while (!queues_[p].empty())
+            {
+                queues_[p].front()->cancelled = true;
+                done_(queues_[p].front().release());
+                queues_[p].pop_front();
+            }
+        }
+    }
+
+    bool MailboxScheduler::runnable(std::chrono::steady_clock::time_point now) const
+    {
+        if (now - lastCycle_ > std::chrono::microseconds(cfg_.idleAfterUs))
+            return true;
+        return grants_ > 0 && now < windowEnd_;
+    }
+
+    void MailboxScheduler::loop()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!stopping_)
+        {
+            int p = 0;
+            while (p < PRIO_COUNT && queues_[p].empty())
+                p++;
+            if (p == PRIO_COUNT)
+            {
+                cv_.wait(lock);
+                continue;
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (!runnable(now))
+            {
+                // Wake up for the next grant, or when the bus turns idle.
+                cv_.wait_until(lock, lastCycle_ + std::chrono::microseconds(cfg_.idleAfterUs) + std::chrono::microseconds(1));
+                continue;
+            }
+            bool idle = now - lastCycle_ > std::chrono::microseconds(cfg_.idleAfterUs);
+            auto windowEnd = windowEnd_;
+            int windowUs = idle ? -1 : static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(windowEnd - now).count());
+            if (grants_ > 0)
+                grants_--;
+            std::unique_ptr<Job> job = std::move(queues_[p].front());
+            queues_[p].pop_front();
+            stats_.served[p]++;
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> ctxGuard(ctxLock_);
+                job->run(ctx_, windowUs);
+            }
+            auto end = std::chrono::steady_clock::now();
+            done_(job.release());
+            lock.lock();
+            if (!idle && end > windowEnd)
+            {
+                auto over = std::chrono::duration_cast<std::chrono::microseconds>(end - windowEnd).count();
+                stats_.overruns++;
+                if (over > stats_.maxOverrunUs)
+                    stats_.maxOverrunUs = static_cast<uint32_t>(over);
+            }
+        }
+    }
+
+} // namespace soemnode
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+extern "C"
+{
+#include "ethercat.h"
+}
+
+namespace soemnode
+{
+
+    // Acyclic mailbox / register traffic queued by JS and executed on a
+    // dedicated thread. Requests are only started inside the idle part of a
+    // processdata period, as reported by the cyclic side through cycleDone(),
+    // so heavy parameter traffic does not push back the next cyclic frame.
+    //
+    // The window bounds when a request starts, not always when it ends: a
+    // job gets the time left in the window and single-frame requests use it
+    // as their timeout, but a mailbox transfer keeps polling the slave until
+    // it answers or its own timeout expires. Such overruns are counted in
+    // Stats and delay the next request; the cyclic frames still go out.
+    class MailboxScheduler
+    {
+    public:
+        enum Priority
+        {
+            PRIO_HIGH = 0,
+            PRIO_NORMAL = 1,
+            PRIO_LOW = 2,
+            PRIO_COUNT = 3
+        };
+
+        struct Job
+        {
+            virtual ~Job() = default;
+            // Runs on the scheduler thread. windowUs is the time left in the
+            // cycle's window, or -1 when the bus is idle. Must not touch any
+            // JS value.
+            virtual void run(ecx_contextt *ctx, int windowUs) = 0;
+            Priority priority = PRIO_NORMAL;
+            // Set by stop() on jobs handed back without being run.
+            bool cancelled = false;
+        };
+
+        struct Config
+        {
+            // Nominal processdata period.
+            uint32_t periodUs = 1000;
+            // Acyclic window per cycle, counted from the end of the exchange.
+            uint32_t budgetUs = 250;
+            // Requests started per cycle.
+            uint32_t maxPerCycle = 1;
+            // Margin kept free before the next cycle starts.
+            uint32_t guardUs = 100;
+            // Without cycleDone() for this long the bus is considered idle and
+            // requests are served back to back.
+            uint32_t idleAfterUs = 10000;
+        };
+
+        struct Stats
+        {
+            uint64_t served[PRIO_COUNT] = {0, 0, 0};
+            uint64_t cycles = 0;
+            // Cycles whose idle time was shorter than the budget + guard.
+            uint64_t skippedCycles = 0;
+            // Jobs still running when their window closed, and the worst
+            // amount by which one did.
+            uint64_t overruns = 0;
+            uint32_t maxOverrunUs = 0;
+            size_t queued[PRIO_COUNT] = {0, 0, 0};
+        };
+
+        using DoneFn = std::function<void(Job *)>;
+
+        // ctxLock is held around each job, so requests issued from other
+        // threads on the same context (see Master::mailboxLock) never interleave.
+        MailboxScheduler(ecx_contextt *ctx, std::mutex &ctxLock, DoneFn done);
+        ~MailboxScheduler();
+
+        void configure(const Config &cfg);
+        Config config();
+        Stats stats();
+
+        void submit(std::unique_ptr<Job> job);
+
+        // Called by the cyclic side once the processdata frames of a cycle
+        // are back. cycleStart is when the cycle's send was issued.
+        void cycleDone(std::chrono::steady_clock::time_point cycleStart, std::chrono::steady_clock::time_point now);
+
+        void stop();
+
+    private:
+        void loop();
+        bool runnable(std::chrono::steady_clock::time_point now) const;
+
+        ecx_contextt *ctx_;
+        std::mutex &ctxLock_;
+        DoneFn done_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::deque<std::unique_ptr<Job>> queues_[PRIO_COUNT];
+        Config cfg_;
+        Stats stats_;
+        uint32_t grants_ = 0;
+        std::chrono::steady_clock::time_point windowEnd_;
+        std::chrono::steady_clock::time_point lastCycle_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+
+} // namespace soemnode
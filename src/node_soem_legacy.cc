@@ -1,208 +1,267 @@
 // N-API port of the historical node-soem NAN binding (node-soem-master.cc)
-// Exposes a NodeSoemMaster class with methods mapped to SOEM ec_* functions.
+// Exposes a NodeSoemMaster class with the legacy method set, implemented as a
+// thin compatibility layer over the context-based Master (addon.cc): each
+// instance owns its own engine, so legacy and new masters can run side by side.
 
-#include <napi.h>
-#include <string>
-#ifdef __cplusplus
-extern "C"
-{
+// Platform-specific includes
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
 #endif
-#include "ethercat.h"
-#ifdef __cplusplus
-}
+#include <winsock2.h>
+#include <windows.h>
 #endif
 
-using namespace Napi;
+#include "soem_wrap.hpp"
 
-class NodeSoemMaster : public ObjectWrap<NodeSoemMaster>
+namespace soemnode
 {
-public:
-    static Object Init(Napi::Env env, Object exports)
-    {
-        Function func = DefineClass(env, "NodeSoemMaster", {
-                                                               InstanceMethod("init", &NodeSoemMaster::InitMaster),
-                                                               InstanceMethod("configInit", &NodeSoemMaster::ConfigInit),
-                                                               InstanceMethod("configMap", &NodeSoemMaster::ConfigMap),
-                                                               InstanceMethod("configDC", &NodeSoemMaster::ConfigDC),
-                                                               InstanceMethod("sendProcessdata", &NodeSoemMaster::SendProcessdata),
-                                                               InstanceMethod("receiveProcessdata", &NodeSoemMaster::ReceiveProcessdata),
-                                                               InstanceMethod("writeState", &NodeSoemMaster::WriteState),
-                                                               InstanceMethod("readState", &NodeSoemMaster::ReadState),
-                                                               InstanceMethod("statecheck", &NodeSoemMaster::Statecheck),
-                                                               InstanceMethod("getSlaves", &NodeSoemMaster::GetSlaves),
-                                                               InstanceMethod("getInterfaceName", &NodeSoemMaster::GetInterfaceName),
-                                                               InstanceMethod("getMap", &NodeSoemMaster::GetMap),
-                                                               InstanceMethod("getExpectedWC", &NodeSoemMaster::GetExpectedWC),
-                                                           });
-
-        exports.Set("NodeSoemMaster", func);
-        return exports;
-    }
 
-    NodeSoemMaster(const CallbackInfo &info) : ObjectWrap<NodeSoemMaster>(info)
+    namespace
     {
-        Env env = info.Env();
-        std::string ifname = "eth0";
-        if (info.Length() > 0 && info[0].IsString())
+        // Historical ec_receive_processdata(5000) and ec_statecheck default.
+        constexpr int kLegacyReceiveTimeout = 5000;
+        constexpr int kLegacyStatecheckTimeout = 1000;
+
+        int optionInt(const Napi::Object &o, const char *key, int def)
         {
-            ifname = info[0].As<String>().Utf8Value();
+            Napi::Value v = o.Get(key);
+            return v.IsNumber() ? v.As<Napi::Number>().Int32Value() : def;
         }
-        ifname_ = strdup(ifname.c_str());
-        memset(ioMap_, 0, sizeof(ioMap_));
     }
 
-    ~NodeSoemMaster()
+    class NodeSoemMaster : public Napi::ObjectWrap<NodeSoemMaster>
     {
-        if (ifname_)
-            free(ifname_);
-    }
+    public:
+        static Napi::Function Init(Napi::Env env)
+        {
+            return DefineClass(env, "NodeSoemMaster", {InstanceMethod("init", &NodeSoemMaster::InitMaster), InstanceMethod("configInit", &NodeSoemMaster::ConfigInit), InstanceMethod("configMap", &NodeSoemMaster::ConfigMap), InstanceMethod("configDC", &NodeSoemMaster::ConfigDC), InstanceMethod("sendProcessdata", &NodeSoemMaster::SendProcessdata), InstanceMethod("receiveProcessdata", &NodeSoemMaster::ReceiveProcessdata), InstanceMethod("writeState", &NodeSoemMaster::WriteState), InstanceMethod("readState", &NodeSoemMaster::ReadState), InstanceMethod("statecheck", &NodeSoemMaster::Statecheck), InstanceMethod("getSlaves", &NodeSoemMaster::GetSlaves), InstanceMethod("getInterfaceName", &NodeSoemMaster::GetInterfaceName), InstanceMethod("getMap", &NodeSoemMaster::GetMap), InstanceMethod("getExpectedWC", &NodeSoemMaster::GetExpectedWC), InstanceMethod("setTimeouts", &NodeSoemMaster::SetTimeouts), InstanceMethod("close", &NodeSoemMaster::Close)});
+        }
 
-private:
-    // Methods
-    Value InitMaster(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int ret = ec_init(ifname_);
-        return Number::New(env, ret);
-    }
+        NodeSoemMaster(const Napi::CallbackInfo &info) : Napi::ObjectWrap<NodeSoemMaster>(info)
+        {
+            Napi::Env env = info.Env();
+            std::string ifname = "eth0";
+            if (info.Length() > 0 && info[0].IsString())
+                ifname = info[0].As<Napi::String>().Utf8Value();
+            if (info.Length() > 1 && info[1].IsObject())
+                applyTimeouts(info[1].As<Napi::Object>());
+            Napi::Object wrapper;
+            engine_ = Master::Create(env, ifname, wrapper);
+            engineRef_ = Napi::Persistent(wrapper);
+        }
 
-    Value ConfigInit(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int ret = ec_config_init(FALSE);
-        return Number::New(env, ret);
-    }
+    private:
+        void applyTimeouts(const Napi::Object &o)
+        {
+            receiveTimeout_ = optionInt(o, "receive", receiveTimeout_);
+            statecheckTimeout_ = optionInt(o, "statecheck", statecheckTimeout_);
+        }
 
-    Value ConfigMap(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int ret = ec_config_map((void *)&ioMap_);
-        return Number::New(env, ret);
-    }
+        // Optional group argument, defaults to 0 like the legacy single-group API.
+        static bool groupArg(const Napi::CallbackInfo &info, size_t idx, uint8 &group)
+        {
+            group = 0;
+            if (info.Length() <= idx || !info[idx].IsNumber())
+                return true;
+            int g = info[idx].As<Napi::Number>().Int32Value();
+            if (g < 0 || g >= EC_MAXGROUP)
+            {
+                Napi::RangeError::New(info.Env(), "group out of range").ThrowAsJavaScriptException();
+                return false;
+            }
+            group = static_cast<uint8>(g);
+            return true;
+        }
 
-    Value ConfigDC(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int ret = ec_configdc();
-        return Number::New(env, ret);
-    }
+        Napi::Value InitMaster(const Napi::CallbackInfo &info)
+        {
+            return Napi::Number::New(info.Env(), engine_->open());
+        }
 
-    Value SendProcessdata(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int ret = ec_send_processdata();
-        return Number::New(env, ret);
-    }
+        Napi::Value ConfigInit(const Napi::CallbackInfo &info)
+        {
+            std::unique_lock<std::mutex> lock;
+            if (!engine_->lockMailbox(info.Env(), lock, "configInit"))
+                return info.Env().Null();
+            return Napi::Number::New(info.Env(), engine_->configInitLocked());
+        }
 
-    Value ReceiveProcessdata(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int ret = ec_receive_processdata(5000);
-        return Number::New(env, ret);
-    }
+        Napi::Value ConfigMap(const Napi::CallbackInfo &info)
+        {
+            uint8 group;
+            if (!groupArg(info, 0, group))
+                return info.Env().Null();
+            std::unique_lock<std::mutex> lock;
+            if (!engine_->lockMailbox(info.Env(), lock, "configMap"))
+                return info.Env().Null();
+            return Napi::Number::New(info.Env(), engine_->mapGroupLocked(group));
+        }
 
-    Value WriteState(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        if (info.Length() < 2)
+        Napi::Value ConfigDC(const Napi::CallbackInfo &info)
         {
-            TypeError::New(env, "writeState requires (slave, state)").ThrowAsJavaScriptException();
-            return env.Null();
+            std::unique_lock<std::mutex> lock;
+            if (!engine_->lockMailbox(info.Env(), lock, "configDC"))
+                return info.Env().Null();
+            return Napi::Number::New(info.Env(), engine_->configDCLocked());
         }
-        int slave = info[0].As<Number>().Int32Value();
-        int reqstate = info[1].As<Number>().Int32Value();
-        ec_slave[slave].state = reqstate;
-        int ret = ec_writestate(slave);
-        return Number::New(env, ret);
-    }
 
-    Value ReadState(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int ret = ec_readstate();
-        return Number::New(env, ret);
-    }
+        Napi::Value SendProcessdata(const Napi::CallbackInfo &info)
+        {
+            uint8 group;
+            if (!groupArg(info, 0, group))
+                return info.Env().Null();
+            return Napi::Number::New(info.Env(), engine_->sendGroup(group));
+        }
 
-    Value Statecheck(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        if (info.Length() < 2)
-        {
-            TypeError::New(env, "statecheck requires (slave, state [, timeout])").ThrowAsJavaScriptException();
-            return env.Null();
-        }
-        int slave = info[0].As<Number>().Int32Value();
-        int reqstate = info[1].As<Number>().Int32Value();
-        int timeout = 1000;
-        if (info.Length() >= 3 && info[2].IsNumber())
-            timeout = info[2].As<Number>().Int32Value();
-        int ret = ec_statecheck(slave, reqstate, timeout);
-        return Number::New(env, ret);
-    }
+        Napi::Value ReceiveProcessdata(const Napi::CallbackInfo &info)
+        {
+            int timeout = receiveTimeout_;
+            if (info.Length() > 0 && info[0].IsNumber())
+                timeout = info[0].As<Napi::Number>().Int32Value();
+            uint8 group;
+            if (!groupArg(info, 1, group))
+                return info.Env().Null();
+            return Napi::Number::New(info.Env(), engine_->receiveGroup(group, timeout));
+        }
 
-    Value GetSlaves(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        Array arr = Array::New(env);
-        int i = 1;
-        while (i <= ec_slavecount)
-        {
-            Object s = Object::New(env);
-            s.Set("name", String::New(env, ec_slave[i].name));
-            s.Set("state", Number::New(env, ec_slave[i].state));
-            s.Set("ALStatuscode", Number::New(env, ec_slave[i].ALstatuscode));
-            s.Set("configadr", Number::New(env, ec_slave[i].configadr));
-            s.Set("aliasadr", Number::New(env, ec_slave[i].aliasadr));
-            unsigned int numbytes = ec_slave[i].Obytes;
-            if ((numbytes == 0) && (ec_slave[i].Obits > 0))
-                numbytes = 1;
-            if (numbytes > 8)
-                numbytes = 8;
-            s.Set("Obits", Number::New(env, ec_slave[i].Obits));
-            s.Set("Obytes", Number::New(env, ec_slave[i].Obytes));
-            s.Set("outputs", ArrayBuffer::New(env, (void *)ec_slave[i].outputs, numbytes));
-            numbytes = ec_slave[i].Ibytes;
-            if ((numbytes == 0) && (ec_slave[i].Ibits > 0))
-                numbytes = 1;
-            if (numbytes > 8)
-                numbytes = 8;
-            s.Set("Ibits", Number::New(env, ec_slave[i].Ibits));
-            s.Set("Ibytes", Number::New(env, ec_slave[i].Ibytes));
-            s.Set("inputs", ArrayBuffer::New(env, (void *)ec_slave[i].inputs, numbytes));
-            s.Set("pdelay", Number::New(env, ec_slave[i].pdelay));
-            arr.Set(i - 1, s);
-            i++;
-        }
-        return arr;
-    }
+        Napi::Value WriteState(const Napi::CallbackInfo &info)
+        {
+            Napi::Env env = info.Env();
+            if (info.Length() < 2)
+            {
+                Napi::TypeError::New(env, "writeState requires (slave, state)").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            int slave = info[0].As<Napi::Number>().Int32Value();
+            int reqstate = info[1].As<Napi::Number>().Int32Value();
+            if (slave < 0 || slave > engine_->slaveCount())
+            {
+                Napi::RangeError::New(env, "slave out of range").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            std::unique_lock<std::mutex> lock;
+            if (!engine_->lockMailbox(env, lock, "writeState"))
+                return env.Null();
+            return Napi::Number::New(env, engine_->writeStateLocked(static_cast<uint16>(slave), static_cast<uint16>(reqstate)));
+        }
 
-    Value GetInterfaceName(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        return String::New(env, ifname_ ? ifname_ : "");
-    }
+        Napi::Value ReadState(const Napi::CallbackInfo &info)
+        {
+            std::unique_lock<std::mutex> lock;
+            if (!engine_->lockMailbox(info.Env(), lock, "readState"))
+                return info.Env().Null();
+            return Napi::Number::New(info.Env(), engine_->readStateLocked());
+        }
 
-    Value GetMap(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        ArrayBuffer buf = ArrayBuffer::New(env, (void *)&ioMap_, sizeof(ioMap_));
-        return buf;
-    }
+        Napi::Value Statecheck(const Napi::CallbackInfo &info)
+        {
+            Napi::Env env = info.Env();
+            if (info.Length() < 2)
+            {
+                Napi::TypeError::New(env, "statecheck requires (slave, state [, timeout])").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            int slave = info[0].As<Napi::Number>().Int32Value();
+            int reqstate = info[1].As<Napi::Number>().Int32Value();
+            int timeout = statecheckTimeout_;
+            if (info.Length() >= 3 && info[2].IsNumber())
+                timeout = info[2].As<Napi::Number>().Int32Value();
+            if (slave < 0 || slave > engine_->slaveCount())
+            {
+                Napi::RangeError::New(env, "slave out of range").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            std::unique_lock<std::mutex> lock;
+            if (!engine_->lockMailbox(env, lock, "statecheck"))
+                return env.Null();
+            int ret = engine_->stateCheckLocked(static_cast<uint16>(slave), static_cast<uint16>(reqstate), timeout);
+            return Napi::Number::New(env, ret);
+        }
 
-    Value GetExpectedWC(const CallbackInfo &info)
-    {
-        Env env = info.Env();
-        int exp = ec_group[0].outputsWKC * 2 + ec_group[0].inputsWKC;
-        return Number::New(env, exp);
-    }
+        Napi::Value GetSlaves(const Napi::CallbackInfo &info)
+        {
+            return engine_->slaveList(info.Env(), "ALStatuscode");
+        }
 
-    char *ifname_{nullptr};
-    char ioMap_[4096];
-};
+        Napi::Value GetInterfaceName(const Napi::CallbackInfo &info)
+        {
+            return Napi::String::New(info.Env(), engine_->ifname());
+        }
 
-Object InitAll(Napi::Env env, Object exports)
-{
-    return NodeSoemMaster::Init(env, exports);
-}
+        // Zero-copy view sized to the mapped image of the group (outputs then
+        // inputs). One buffer per group and mapping: later calls return the
+        // same ArrayBuffer until configMap runs again for the group. Each
+        // buffer holds the IOmap it was made from, so it never dangles.
+        Napi::Value GetMap(const Napi::CallbackInfo &info)
+        {
+            Napi::Env env = info.Env();
+            uint8 group;
+            if (!groupArg(info, 0, group) || engine_->hotplugging(group))
+                return env.Null();
+            MapView &view = maps_[group];
+            uint32_t generation = engine_->mapGeneration(group);
+            if (!view.buffer.IsEmpty() && view.generation == generation)
+                return view.buffer.Value();
+
+            const ec_groupt &grp = engine_->context()->grouplist[group];
+            size_t bytes = 0;
+            if (grp.outputs || grp.inputs)
+                bytes = static_cast<size_t>(grp.Obytes) + grp.Ibytes;
+            auto *hold = new std::shared_ptr<std::vector<uint8>>(engine_->groupIOmapBuffer(group));
+            Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
+                env, (*hold)->data(), bytes,
+                [](Napi::Env, void *, std::shared_ptr<std::vector<uint8>> *map)
+                { delete map; },
+                hold);
+            view.buffer = Napi::Persistent(buffer);
+            view.generation = generation;
+            return buffer;
+        }
+
+        Napi::Value GetExpectedWC(const Napi::CallbackInfo &info)
+        {
+            uint8 group;
+            if (!groupArg(info, 0, group) || engine_->hotplugging(group))
+                return info.Env().Null();
+            const ec_groupt &grp = engine_->context()->grouplist[group];
+            return Napi::Number::New(info.Env(), grp.outputsWKC * 2 + grp.inputsWKC);
+        }
+
+        Napi::Value SetTimeouts(const Napi::CallbackInfo &info)
+        {
+            Napi::Env env = info.Env();
+            if (info.Length() < 1 || !info[0].IsObject())
+            {
+                Napi::TypeError::New(env, "setTimeouts requires ({ receive?, statecheck? })").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            applyTimeouts(info[0].As<Napi::Object>());
+            return env.Undefined();
+        }
+
+        Napi::Value Close(const Napi::CallbackInfo &info)
+        {
+            engine_->shutdown();
+            return info.Env().Undefined();
+        }
+
+        struct MapView
+        {
+            Napi::Reference<Napi::ArrayBuffer> buffer;
+            uint32_t generation = 0;
+        };
+
+        Master *engine_ = nullptr;
+        Napi::ObjectReference engineRef_;
+        MapView maps_[EC_MAXGROUP];
+        int receiveTimeout_ = kLegacyReceiveTimeout;
+        int statecheckTimeout_ = kLegacyStatecheckTimeout;
+    };
+
+    Napi::Function NodeSoemMasterInit(Napi::Env env)
+    {
+        return NodeSoemMaster::Init(env);
+    }
 
-NODE_API_MODULE(node_soem_legacy, InitAll)
+} // namespace soemnode
@@ -1,6 +1,13 @@
 #pragma once
 
 #include <napi.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 // Platform-specific includes for SOEM
 #ifdef _WIN32
@@ -21,15 +28,86 @@ extern "C"
 #include "ethercat.h"
 }
 
+#include "diagnostics.hpp"
+#include "historian.hpp"
+#include "iomap.hpp"
+#include "mailbox_scheduler.hpp"
+#include "topology.hpp"
+
 namespace soemnode
 {
 
+    // Legacy node-soem API (node_soem_legacy.cc)
+    Napi::Function NodeSoemMasterInit(Napi::Env env);
+
     class Master : public Napi::ObjectWrap<Master>
     {
     public:
         static Napi::Function Init(Napi::Env env);
         static Napi::Value listInterfaces(const Napi::CallbackInfo &info);
         Master(const Napi::CallbackInfo &info);
+        ~Master();
+
+        // C++ entry points shared with the NodeSoemMaster compatibility layer
+        // (node_soem_legacy.cc), which drives the same per-instance context.
+        static Master *Create(Napi::Env env, const std::string &ifname, Napi::Object &wrapper);
+        ecx_contextt *context() { return &ctx_; }
+        const std::string &ifname() const { return ifname_; }
+        int open();
+        void shutdown();
+        // mapGroup waits for the mailbox lock (worker threads); mapGroupLocked
+        // expects the caller to hold it, e.g. through lockMailbox.
+        int mapGroup(uint8 group);
+        int mapGroupLocked(uint8 group);
+        int sendGroup(uint8 group);
+        int receiveGroup(uint8 group, int timeout);
+        // Configuration and AL state calls. They return 0 when the master is
+        // not open (or the slave is out of range) and expect the caller to
+        // hold the mailbox lock: ecx_config_init reads the SII and all of
+        // them share the context with the mailbox scheduler.
+        int configInitLocked();
+        int configDCLocked();
+        int writeStateLocked(uint16 slave, uint16 state);
+        int readStateLocked();
+        int stateCheckLocked(uint16 slave, uint16 state, int timeout);
+        // Takes the mailbox lock (EBUSY while a transfer or a hot-plug holds it).
+        Napi::Value slaveList(Napi::Env env, const char *statusKey);
+        // Slave count published to the JS thread. ctx_.slavecount only
+        // changes under the mailbox lock, in configInit and in the
+        // configNewSlaves worker; bound checks that must not wait for the
+        // lock use this copy, updated on the JS thread.
+        int slaveCount() const { return slaveCount_; }
+        // Called on the JS thread when the configNewSlaves worker settles.
+        void endHotplug();
+        // True while configNewSlaves maps group: its grouplist entry and
+        // IOmap belong to the worker until then.
+        bool hotplugging(uint8 group) const { return group && group == hotplugGroup_; }
+
+        // Per-group IOmap owned by the instance; SOEM keeps pointers into it
+        // (grouplist[].outputs / inputs) for every later exchange. mapGroup may
+        // move a group to a larger buffer: zero-copy views hold the buffer
+        // they were made from and check the generation to detect a re-map.
+        uint8 *groupIOmap(uint8 group);
+        std::shared_ptr<std::vector<uint8>> groupIOmapBuffer(uint8 group);
+        uint32_t mapGeneration(uint8 group) const { return mapGeneration_[group]; }
+
+        // Serializes mailbox transactions (CoE, SoE, EEPROM, mapping) between
+        // the JS thread, the mailbox scheduler and background workers: SOEM
+        // keeps per-slave mailbox counters and buffers in the shared context.
+        std::mutex &mailboxLock() { return mailboxLock_; }
+
+        // Takes the mailbox lock for a synchronous call on the JS thread.
+        // Fails fast instead of waiting out a transfer: throws an Error with
+        // code EBUSY and returns false.
+        bool lockMailbox(Napi::Env env, std::unique_lock<std::mutex> &lock, const char *what);
+
+        // Background users of the context (object dictionary scans). Called
+        // on the JS thread; fails once the master is closed or closing.
+        // shutdown() waits for every begin to be matched by an end, and
+        // workers poll closing() to stop early.
+        bool beginBackground();
+        void endBackground();
+        bool closing() const { return closing_; }
 
     private:
         Napi::Value init(const Napi::CallbackInfo &info);
@@ -38,6 +116,7 @@ namespace soemnode
         Napi::Value state(const Napi::CallbackInfo &info);
         Napi::Value readState(const Napi::CallbackInfo &info);
         Napi::Value sdoRead(const Napi::CallbackInfo &info);
+        Napi::Value sdoReadInto(const Napi::CallbackInfo &info);
         Napi::Value sdoWrite(const Napi::CallbackInfo &info);
         Napi::Value sendProcessdata(const Napi::CallbackInfo &info);
         Napi::Value receiveProcessdata(const Napi::CallbackInfo &info);
@@ -49,15 +128,53 @@ namespace soemnode
         Napi::Value slaveMbxCyclic(const Napi::CallbackInfo &info);
         Napi::Value configDC(const Napi::CallbackInfo &info);
         Napi::Value getSlaves(const Napi::CallbackInfo &info);
+
+        // Hot-plug: read-only bus scan and configuration of appended slaves
+        Napi::Value scanTopology(const Napi::CallbackInfo &info);
+        Napi::Value configNewSlaves(const Napi::CallbackInfo &info);
+        Napi::Value slaveIdentity(const Napi::CallbackInfo &info);
+
+        // CoE object dictionary browsing (SDO information services, async)
+        Napi::Value readObjectDictionary(const Napi::CallbackInfo &info);
+
         Napi::Value initRedundant(const Napi::CallbackInfo &info);
+        Napi::Value redundancyStatus(const Napi::CallbackInfo &info);
         Napi::Value configMapGroup(const Napi::CallbackInfo &info);
         Napi::Value sendProcessdataGroup(const Napi::CallbackInfo &info);
         Napi::Value receiveProcessdataGroup(const Napi::CallbackInfo &info);
+        Napi::Value exchange(const Napi::CallbackInfo &info);
+        Napi::Value processImageLayout(const Napi::CallbackInfo &info);
         Napi::Value mbxHandler(const Napi::CallbackInfo &info);
+
+        // Acyclic request queue served in the idle part of each cycle
+        Napi::Value configureMailbox(const Napi::CallbackInfo &info);
+        Napi::Value mailboxSubmit(const Napi::CallbackInfo &info);
+        Napi::Value mailboxStatus(const Napi::CallbackInfo &info);
+        void ensureMailbox(Napi::Env env);
+        // Settles a finished job's promise on the JS thread and drops the
+        // keep-alive taken on submit once nothing is pending. Jobs whose
+        // completion could not be queued to the JS thread are parked in
+        // mbxOrphans_ and rejected by settleOrphans().
+        void settleMailboxJob(Napi::Env env, MailboxScheduler::Job *job, const char *error = nullptr);
+        void settleOrphans(Napi::Env env);
         Napi::Value elist2string(const Napi::CallbackInfo &info);
 
+        // Binary diagnostics ring (SOEM error list + ESC error counters)
+        Napi::Value configureDiagnostics(const Napi::CallbackInfo &info);
+        Napi::Value drainDiagnostics(const Napi::CallbackInfo &info);
+        Napi::Value diagnosticsStatus(const Napi::CallbackInfo &info);
+        void ensureDiagnostics();
+
+        // Process data history (memory-mapped segments, written off-cycle)
+        Napi::Value startHistorian(const Napi::CallbackInfo &info);
+        Napi::Value stopHistorian(const Napi::CallbackInfo &info);
+        Napi::Value historianStatus(const Napi::CallbackInfo &info);
+        static Napi::Value readHistory(const Napi::CallbackInfo &info);
+        void historianRecord(int wkc, uint8 group);
+
         // SoE / EoE / FoE
         Napi::Value SoEread(const Napi::CallbackInfo &info);
+        Napi::Value SoEreadInto(const Napi::CallbackInfo &info);
         Napi::Value SoEwrite(const Napi::CallbackInfo &info);
 
         // EEPROM helpers
@@ -75,9 +192,82 @@ namespace soemnode
         Napi::Value dcsync0(const Napi::CallbackInfo &info);
         Napi::Value dcsync01(const Napi::CallbackInfo &info);
 
+        // Container for sdoRead / SoEread so large objects are not bounded by a
+        // stack buffer. Up to the default transfer size it is reused across
+        // calls; larger requests get oversize, which lives for the call only.
+        uint8 *scratch(size_t size, std::vector<uint8> &oversize);
+
+        // Cable redundancy bookkeeping around the processdata exchange: frames
+        // sent since the last receive are tracked so the receive side can tell
+        // from the source MAC seen on each socket whether the ring is closed.
+        // Arm runs before the send, Sent right after it.
+        void redundancyArm();
+        void redundancySent();
+        void redundancyTrack(int wkc, uint8 group);
+
+        struct RedundancyStats
+        {
+            bool lineBreak = false;
+            uint32 lineBreaks = 0;
+            uint64 cycles = 0;
+            uint64 primaryFrames = 0;
+            uint64 secondaryFrames = 0;
+            uint64 lostFrames = 0;
+            uint32 lastFailoverCycles = 0;
+            uint32 maxFailoverCycles = 0;
+            double lastFailoverUs = 0;
+            double maxFailoverUs = 0;
+            // Failover in progress: cycles with a short WKC since the last complete one.
+            bool failoverPending = false;
+            uint32 pendingCycles = 0;
+            std::chrono::steady_clock::time_point lastComplete;
+        };
+
         std::string ifname_ = "eth0";
         bool opened_ = false;
         ecx_contextt ctx_ = {0};
+        std::vector<uint8> mbxbuf_;
+        std::shared_ptr<std::vector<uint8>> iomap_[EC_MAXGROUP];
+        uint32_t mapGeneration_[EC_MAXGROUP] = {};
+
+        // Secondary port state must outlive ecx_init_redundant: SOEM keeps a
+        // pointer to it in ctx_.port.redport for every subsequent frame.
+        ecx_redportt redport_ = {};
+        bool redundant_ = false;
+        uint8 redIdx_[EC_MAXBUF] = {};
+        bool redIdxArmed_[EC_MAXBUF] = {};
+        int redIdxCount_ = 0;
+        // Buffer indexes whose source MAC was cleared by the last arm.
+        bool redFree_[EC_MAXBUF] = {};
+        RedundancyStats red_;
+
+        std::chrono::steady_clock::time_point cycleStart_;
+        MailboxScheduler::Config mbxConfig_;
+        std::unique_ptr<MailboxScheduler> mbx_;
+        Napi::ThreadSafeFunction mbxTsfn_;
+        uint32_t mbxPending_ = 0;
+        std::mutex mbxOrphanMtx_;
+        std::vector<MailboxScheduler::Job *> mbxOrphans_;
+
+        std::mutex mailboxLock_;
+        std::mutex bgMtx_;
+        std::condition_variable bgCv_;
+        int bgActive_ = 0;
+        std::atomic<bool> closing_{false};
+
+        std::unique_ptr<Historian> hist_;
+
+        Diagnostics::Config diagConfig_;
+        std::unique_ptr<Diagnostics> diag_;
+        uint8 histGroup_ = 0;
+        int slaveCount_ = 0;
+        // Group being configured by configNewSlaves (0: none). JS thread only;
+        // exchanges of that group are refused until the worker settles.
+        uint8 hotplugGroup_ = 0;
+        // Map generation the historian ranges were checked against, and the
+        // end of the furthest range.
+        uint32_t histGeneration_ = 0;
+        uint32_t histExtent_ = 0;
     };
 
 } // namespace soemnode
\ No newline at end of file
@@ -0,0 +1,345 @@
+// Platform-specific includes
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <windows.h>
+#endif
+
+#include "topology.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace soemnode
+{
+
+    namespace
+    {
+        // Auto-increment address of a 1-based chain position.
+        uint16 autoIncrement(int position)
+        {
+            return static_cast<uint16>(1 - position);
+        }
+
+        void applyTopology(ec_slavet &sl, uint16 dlStatus)
+        {
+            uint8 links = 0;
+            uint8 ports = topologyOpenPorts(dlStatus);
+            for (int p = 0; p < 4; p++)
+            {
+                if (ports & (1 << p))
+                    links++;
+            }
+            sl.topology = links;
+            sl.activeports = ports;
+        }
+
+        // Same parent search as ecx_config_init, based on the link count of
+        // the slaves before this one.
+        void findParent(ecx_contextt *ctx, int slave)
+        {
+            ctx->slavelist[slave].parent = 0;
+            int topoc = 0;
+            for (int slavec = slave - 1; slavec > 0; slavec--)
+            {
+                uint8 topology = ctx->slavelist[slavec].topology;
+                if (topology == 1)
+                    topoc--; // end point
+                if (topology == 3)
+                    topoc++; // split
+                if (topology == 4)
+                    topoc += 2; // cross
+                if ((topoc >= 0 && topology > 1) || slavec == 1)
+                {
+                    ctx->slavelist[slave].parent = static_cast<uint16>(slavec);
+                    break;
+                }
+            }
+        }
+
+        // Per-slave part of ecx_config_init, with FP addressing only so the
+        // configured slaves never see a broadcast write.
+        bool configureSlave(ecx_contextt *ctx, int slave, uint16 dlStatus, uint8 group)
+        {
+            ecx_portt *port = &ctx->port;
+            uint16 adp = autoIncrement(slave);
+            ec_slavet &sl = ctx->slavelist[slave];
+            std::memset(&sl, 0, sizeof(sl));
+
+            sl.Itype = etohs(ecx_APRDw(port, adp, ECT_REG_PDICTL, EC_TIMEOUTRET3));
+            ecx_APWRw(port, adp, ECT_REG_STADR, htoes(static_cast<uint16>(slave + EC_NODEOFFSET)), EC_TIMEOUTRET3);
+            ecx_APWRw(port, adp, ECT_REG_DLCTL, htoes(0), EC_TIMEOUTRET3);
+            uint16 configadr = etohs(ecx_APRDw(port, adp, ECT_REG_STADR, EC_TIMEOUTRET3));
+            if (configadr != slave + EC_NODEOFFSET)
+                return false;
+            sl.configadr = configadr;
+
+            // Defaults ecx_config_init sets by broadcast, in the same order.
+            // The DC registers are reset but DC is not configured.
+            uint8 zeros[64] = {0};
+            ecx_FPWR(port, configadr, ECT_REG_DLPORT, 1, zeros, EC_TIMEOUTRET3); // automatic loop control
+            ecx_FPWRw(port, configadr, ECT_REG_IRQMASK, htoes(0x0004), EC_TIMEOUTRET3);
+            ecx_FPWR(port, configadr, ECT_REG_RXERR, 8, zeros, EC_TIMEOUTRET3); // reset CRC counters
+            ecx_FPWR(port, configadr, ECT_REG_FMMU0, 16 * 3, zeros, EC_TIMEOUTRET3);
+            ecx_FPWR(port, configadr, ECT_REG_SM0, 8 * 4, zeros, EC_TIMEOUTRET3);
+            ecx_FPWR(port, configadr, ECT_REG_DCSYNCACT, 1, zeros, EC_TIMEOUTRET3);
+            ecx_FPWR(port, configadr, ECT_REG_DCSYSTIME, 4, zeros, EC_TIMEOUTRET3);
+            ecx_FPWRw(port, configadr, ECT_REG_DCSPEEDCNT, htoes(0x1000), EC_TIMEOUTRET3);
+            ecx_FPWRw(port, configadr, ECT_REG_DCTIMEFILT, htoes(0x0c00), EC_TIMEOUTRET3);
+            ecx_FPWR(port, configadr, ECT_REG_DLALIAS, 1, zeros, EC_TIMEOUTRET3); // ignore the alias register
+            ecx_FPWRw(port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_INIT | EC_STATE_ACK), EC_TIMEOUTRET3);
+            ecx_FPWRw(port, configadr, ECT_REG_EEPCFG, htoes(2), EC_TIMEOUTRET3); // EEPROM to PDI
+            ecx_FPWRw(port, configadr, ECT_REG_EEPCFG, htoes(0), EC_TIMEOUTRET3); // then to the master
+
+            uint16 alias = 0;
+            ecx_FPRD(port, configadr, ECT_REG_ALIAS, sizeof(alias), &alias, EC_TIMEOUTRET3);
+            sl.aliasadr = etohs(alias);
+            if (etohs(ecx_FPRDw(port, configadr, ECT_REG_EEPSTAT, EC_TIMEOUTRET3)) & EC_ESTAT_R64)
+                sl.eep_8byte = 1;
+
+            sl.eep_man = etohl(ecx_readeeprom(ctx, static_cast<uint16>(slave), ECT_SII_MANUF, EC_TIMEOUTEEP));
+            sl.eep_id = etohl(ecx_readeeprom(ctx, static_cast<uint16>(slave), ECT_SII_ID, EC_TIMEOUTEEP));
+            sl.eep_rev = etohl(ecx_readeeprom(ctx, static_cast<uint16>(slave), ECT_SII_REV, EC_TIMEOUTEEP));
+            uint32 mbx = etohl(ecx_readeeprom(ctx, static_cast<uint16>(slave), ECT_SII_RXMBXADR, EC_TIMEOUTEEP));
+            sl.mbx_wo = static_cast<uint16>(mbx & 0xFFFF);
+            sl.mbx_l = static_cast<uint16>(mbx >> 16);
+            if (sl.mbx_l > 0)
+            {
+                mbx = etohl(ecx_readeeprom(ctx, static_cast<uint16>(slave), ECT_SII_TXMBXADR, EC_TIMEOUTEEP));
+                sl.mbx_ro = static_cast<uint16>(mbx & 0xFFFF);
+                sl.mbx_rl = static_cast<uint16>(mbx >> 16);
+                if (sl.mbx_rl == 0)
+                    sl.mbx_rl = sl.mbx_l;
+                sl.mbx_proto = static_cast<uint16>(etohl(ecx_readeeprom(ctx, static_cast<uint16>(slave), ECT_SII_MBXPROTO, EC_TIMEOUTEEP)));
+            }
+
+            applyTopology(sl, dlStatus);
+            sl.ptype = static_cast<uint8>(etohs(ecx_FPRDw(port, configadr, ECT_REG_PORTDES, EC_TIMEOUTRET3)) & 0xFF);
+            sl.hasdc = (etohs(ecx_FPRDw(port, configadr, ECT_REG_ESCSUP, EC_TIMEOUTRET3)) & 0x04) ? TRUE : FALSE;
+            sl.group = group;
+
+            if (sl.mbx_l > 0)
+            {
+                sl.SMtype[0] = 1;
+                sl.SMtype[1] = 2;
+                sl.SMtype[2] = 3;
+                sl.SMtype[3] = 4;
+                sl.SM[0].StartAddr = htoes(sl.mbx_wo);
+                sl.SM[0].SMlength = htoes(sl.mbx_l);
+                sl.SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
+                sl.SM[1].StartAddr = htoes(sl.mbx_ro);
+                sl.SM[1].SMlength = htoes(sl.mbx_rl);
+                sl.SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
+            }
+
+            ecx_eeprom2master(ctx, static_cast<uint16>(slave));
+            int16 ssigen = ecx_siifind(ctx, static_cast<uint16>(slave), ECT_SII_GENERAL);
+            if (ssigen)
+            {
+                sl.CoEdetails = ecx_siigetbyte(ctx, static_cast<uint16>(slave), ssigen + 0x07);
+                sl.FoEdetails = ecx_siigetbyte(ctx, static_cast<uint16>(slave), ssigen + 0x08);
+                sl.EoEdetails = ecx_siigetbyte(ctx, static_cast<uint16>(slave), ssigen + 0x09);
+                sl.SoEdetails = ecx_siigetbyte(ctx, static_cast<uint16>(slave), ssigen + 0x0a);
+                if (ecx_siigetbyte(ctx, static_cast<uint16>(slave), ssigen + 0x0d) & 0x02)
+                    sl.blockLRW = 1;
+                sl.Ebuscurrent = static_cast<int16>(ecx_siigetbyte(ctx, static_cast<uint16>(slave), ssigen + 0x0e) +
+                                                    (ecx_siigetbyte(ctx, static_cast<uint16>(slave), ssigen + 0x0f) << 8));
+            }
+            if (ecx_siifind(ctx, static_cast<uint16>(slave), ECT_SII_STRING) > 0)
+                ecx_siistring(ctx, sl.name, static_cast<uint16>(slave), 1);
+            else
+                std::snprintf(sl.name, sizeof(sl.name), "? M:%8.8x I:%8.8x", static_cast<unsigned>(sl.eep_man), static_cast<unsigned>(sl.eep_id));
+
+            ec_eepromSMt eepSM;
+            if (ecx_siiSM(ctx, static_cast<uint16>(slave), &eepSM) > 0)
+            {
+                int n = 0;
+                do
+                {
+                    sl.SM[n].StartAddr = htoes(eepSM.PhStart);
+                    sl.SM[n].SMlength = htoes(eepSM.Plength);
+                    sl.SM[n].SMflags = htoel(static_cast<uint32>(eepSM.Creg) + (static_cast<uint32>(eepSM.Activate) << 16));
+                    n++;
+                } while (n < EC_MAXSM && ecx_siiSMnext(ctx, static_cast<uint16>(slave), &eepSM, static_cast<uint16>(n)));
+            }
+            ec_eepromFMMUt eepFMMU;
+            if (ecx_siiFMMU(ctx, static_cast<uint16>(slave), &eepFMMU))
+            {
+                if (eepFMMU.FMMU0 != 0xff)
+                    sl.FMMU0func = eepFMMU.FMMU0;
+                if (eepFMMU.FMMU1 != 0xff)
+                    sl.FMMU1func = eepFMMU.FMMU1;
+                if (eepFMMU.FMMU2 != 0xff)
+                    sl.FMMU2func = eepFMMU.FMMU2;
+                if (eepFMMU.FMMU3 != 0xff)
+                    sl.FMMU3func = eepFMMU.FMMU3;
+            }
+
+            if (sl.mbx_l > 0)
+            {
+                if (sl.SM[0].StartAddr == 0)
+                {
+                    sl.SM[0].StartAddr = htoes(sl.mbx_wo);
+                    sl.SM[0].SMlength = htoes(sl.mbx_l);
+                    sl.SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
+                }
+                if (sl.SM[1].StartAddr == 0)
+                {
+                    sl.SM[1].StartAddr = htoes(sl.mbx_ro);
+                    sl.SM[1].SMlength = htoes(sl.mbx_rl);
+                    sl.SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
+                }
+                ecx_FPWR(port, configadr, ECT_REG_SM0, sizeof(ec_smt) * 2, &sl.SM[0], EC_TIMEOUTRET3);
+            }
+            ecx_eeprom2pdi(ctx, static_cast<uint16>(slave));
+            ecx_FPWRw(port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_PRE_OP | EC_STATE_ACK), EC_TIMEOUTRET3);
+            return true;
+        }
+    }
+
+    uint8 topologyOpenPorts(uint16 dlStatus)
+    {
+        uint8 ports = 0;
+        if ((dlStatus & 0x0300) == 0x0200)
+            ports |= 0x01;
+        if ((dlStatus & 0x0c00) == 0x0800)
+            ports |= 0x02;
+        if ((dlStatus & 0x3000) == 0x2000)
+            ports |= 0x04;
+        if ((dlStatus & 0xc000) == 0x8000)
+            ports |= 0x08;
+        return ports;
+    }
+
+    bool scanTopology(ecx_contextt *ctx, bool identify, TopologyScan &out)
+    {
+        out = TopologyScan();
+        ecx_portt *port = &ctx->port;
+        uint16 w = 0;
+        int count = ecx_BRD(port, 0x0000, ECT_REG_TYPE, sizeof(w), &w, EC_TIMEOUTSAFE);
+        if (count < 0)
+            return false;
+        if (count > EC_MAXSLAVE - 1)
+            count = EC_MAXSLAVE - 1;
+        out.busCount = count;
+
+        out.entries.reserve(count);
+        for (int pos = 1; pos <= count; pos++)
+        {
+            uint16 adp = autoIncrement(pos);
+            TopologyEntry e;
+            e.position = static_cast<uint16>(pos);
+            uint16 addr[2] = {0, 0};
+            if (ecx_APRD(port, adp, ECT_REG_STADR, sizeof(addr), addr, EC_TIMEOUTRET3) > 0)
+            {
+                e.configadr = etohs(addr[0]);
+                e.aliasadr = etohs(addr[1]);
+            }
+            e.dlStatus = etohs(ecx_APRDw(port, adp, ECT_REG_DLSTAT, EC_TIMEOUTRET3));
+            uint16 al[3] = {0, 0, 0};
+            if (ecx_APRD(port, adp, ECT_REG_ALSTAT, sizeof(al), al, EC_TIMEOUTRET3) > 0)
+            {
+                e.alStatus = etohs(al[0]);
+                e.alStatusCode = etohs(al[2]);
+            }
+            out.entries.push_back(e);
+        }
+        matchTopology(ctx, out);
+        for (TopologyEntry &e : out.entries)
+        {
+            if (e.slave || !identify)
+                continue;
+            uint16 adp = autoIncrement(e.position);
+            e.vendorId = static_cast<uint32>(ecx_readeepromAP(ctx, adp, ECT_SII_MANUF, EC_TIMEOUTEEP));
+            e.productCode = static_cast<uint32>(ecx_readeepromAP(ctx, adp, ECT_SII_ID, EC_TIMEOUTEEP));
+            e.revision = static_cast<uint32>(ecx_readeepromAP(ctx, adp, ECT_SII_REV, EC_TIMEOUTEEP));
+            e.identified = true;
+        }
+        return true;
+    }
+
+    void matchTopology(const ecx_contextt *ctx, TopologyScan &scan)
+    {
+        std::vector<bool> seen(static_cast<size_t>(ctx->slavecount) + 1, false);
+        for (TopologyEntry &e : scan.entries)
+        {
+            for (int s = 1; e.configadr && s <= ctx->slavecount; s++)
+            {
+                const ec_slavet &sl = ctx->slavelist[s];
+                if (sl.configadr == e.configadr && !seen[s])
+                {
+                    e.slave = static_cast<uint16>(s);
+                    e.identified = true;
+                    e.vendorId = sl.eep_man;
+                    e.productCode = sl.eep_id;
+                    e.revision = sl.eep_rev;
+                    seen[s] = true;
+                    break;
+                }
+            }
+        }
+        scan.removed.clear();
+        for (int s = 1; s <= ctx->slavecount; s++)
+        {
+            if (!seen[s])
+                scan.removed.push_back(static_cast<uint16>(s));
+        }
+    }
+
+    int appendedSlaveCount(int configured, const TopologyScan &scan, std::string &err)
+    {
+        if (configured <= 0)
+        {
+            err = "no configured slaves, run configInit first";
+            return -1;
+        }
+        if (!scan.removed.empty())
+        {
+            err = "configured slaves are missing from the bus";
+            return -1;
+        }
+        for (const TopologyEntry &e : scan.entries)
+        {
+            if (e.position <= configured && e.slave != e.position)
+            {
+                err = "bus order changed at position " + std::to_string(e.position);
+                return -1;
+            }
+        }
+        return scan.busCount > configured ? scan.busCount - configured : 0;
+    }
+
+    int configureAppendedSlaves(ecx_contextt *ctx, const TopologyScan &scan, uint8 group, std::string &err)
+    {
+        int configured = ctx->slavecount;
+        int appended = appendedSlaveCount(configured, scan, err);
+        if (appended <= 0)
+            return appended;
+
+        // The former end of line now has one more open port.
+        for (const TopologyEntry &e : scan.entries)
+        {
+            if (e.position <= configured)
+                applyTopology(ctx->slavelist[e.position], e.dlStatus);
+        }
+        // New entries are filled in past slavecount and published together
+        // once they are complete: readers bounded by slavecount never see a
+        // half-configured slave.
+        int last = configured;
+        for (int slave = configured + 1; slave <= scan.busCount; slave++)
+        {
+            if (!configureSlave(ctx, slave, scan.entries[slave - 1].dlStatus, group))
+            {
+                err = "cannot set station address of position " + std::to_string(slave);
+                break;
+            }
+            findParent(ctx, slave);
+            last = slave;
+        }
+        ctx->slavecount = last;
+        return last - configured;
+    }
+
+} // namespace soemnode
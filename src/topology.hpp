@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "ethercat.h"
+}
+
+namespace soemnode
+{
+
+    // View of the bus built from broadcast and auto-increment register reads.
+    // Configured slaves keep their state, station address and EEPROM
+    // ownership; only identify touches the EEPROM interface of new slaves.
+    struct TopologyEntry
+    {
+        uint16 position = 0;  // 1-based position in the chain
+        uint16 configadr = 0; // station address, 0 if never configured
+        uint16 aliasadr = 0;
+        uint16 slave = 0;     // matching configured slave, 0 if new
+        bool identified = false;
+        uint32 vendorId = 0;
+        uint32 productCode = 0;
+        uint32 revision = 0;
+        uint16 alStatus = 0;
+        uint16 alStatusCode = 0;
+        uint16 dlStatus = 0;
+    };
+
+    struct TopologyScan
+    {
+        int busCount = 0;
+        std::vector<TopologyEntry> entries;
+        // Configured slaves whose station address no longer answers.
+        std::vector<uint16> removed;
+    };
+
+    // Ports with link and communication established and loop open (same rule
+    // as ecx_config_init uses for the topology).
+    uint8 topologyOpenPorts(uint16 dlStatus);
+
+    // identify: read vendor/product/revision from SII for slaves that are not
+    // already known; known slaves reuse the identity read by configInit.
+    // Reading SII writes the EEPROM control/address registers (0x0502-0x0505)
+    // of those slaves, so the caller must hold the context lock.
+    bool scanTopology(ecx_contextt *ctx, bool identify, TopologyScan &out);
+
+    // Matches scanned positions to configured slaves by station address and
+    // lists the configured slaves that were not seen. No bus access.
+    void matchTopology(const ecx_contextt *ctx, TopologyScan &scan);
+
+    // Checks that the configured slaves are still the head of the chain.
+    // Returns the number of slaves appended after them, or -1 with err set.
+    int appendedSlaveCount(int configured, const TopologyScan &scan, std::string &err);
+
+    // Brings slaves found after the last configured one to PRE-OP and assigns
+    // them to group, leaving the configured slaves untouched. slavecount is
+    // raised once, after the new entries are complete; the caller must hold
+    // the context lock. Returns the number of slaves added, or -1 with err
+    // set when the bus changed in a way that needs a full configInit.
+    int configureAppendedSlaves(ecx_contextt *ctx, const TopologyScan &scan, uint8 group, std::string &err);
+
+} // namespace soemnode
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal assertion helpers for the native tests: a failed CHECK reports its
+// location and the test keeps going; main returns checkResult().
+namespace soemnode_test
+{
+
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline int checkResult(const char *name)
+    {
+        if (failures())
+            std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures());
+        else
+            std::printf("%s: ok\n", name);
+        return failures() ? 1 : 0;
+    }
+
+} // namespace soemnode_test
+
+#define CHECK(cond)                                                                     \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(cond))                                                                    \
+        {                                                                               \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            soemnode_test::failures()++;                                                \
+        }                                                                               \
+    } while (0)
@@ -0,0 +1,137 @@
+// Diagnostics ring: SOEM error list -> records, ring overwrite accounting,
+// partial drains and the context lock. The counter thread is disabled, so
+// no bus is needed.
+
+#include "check.hpp"
+#include "diagnostics.hpp"
+
+#include <cstdint>
+#include <mutex>
+
+using namespace soemnode;
+
+namespace
+{
+
+    ecx_contextt ctx;
+
+    void pushSdoAbort(uint16 slave, int32 abortCode)
+    {
+        ec_errort e = {};
+        e.Slave = slave;
+        e.Index = 0x6040;
+        e.SubIdx = 1;
+        e.Etype = EC_ERR_TYPE_SDO_ERROR;
+        e.AbortCode = abortCode;
+        ecx_pusherror(&ctx, &e);
+    }
+
+    Diagnostics::Config ringOf(uint32_t capacity)
+    {
+        Diagnostics::Config cfg;
+        cfg.capacity = capacity;
+        cfg.counterIntervalMs = 0;
+        return cfg;
+    }
+
+    void errorListToRecords()
+    {
+        ctx = ecx_contextt();
+        std::mutex ctxLock;
+        Diagnostics d(&ctx, ctxLock);
+        d.configure(ringOf(16));
+
+        pushSdoAbort(2, 0x06020000);
+        ec_errort em = {};
+        em.Slave = 3;
+        em.Etype = EC_ERR_TYPE_EMERGENCY;
+        em.ErrorCode = 0x8130;
+        em.ErrorReg = 0x11;
+        em.b1 = 0x22;
+        em.w1 = 0x3344;
+        em.w2 = 0x5566;
+        ecx_pusherror(&ctx, &em);
+
+        d.collectErrors();
+        // Collected entries are gone from SOEM's list.
+        CHECK(!ecx_iserror(&ctx));
+
+        Diagnostics::Record out[4];
+        CHECK(d.drain(out, 4) == 2);
+        CHECK(out[0].slave == 2 && out[0].type == EC_ERR_TYPE_SDO_ERROR);
+        CHECK(out[0].code == 0x06020000 && out[0].detail == ((0x6040 << 8) | 1));
+        CHECK(out[1].slave == 3 && out[1].type == EC_ERR_TYPE_EMERGENCY);
+        CHECK(out[1].code == 0x8130 && out[1].detail == (0x11 | (0x22 << 8)));
+        CHECK(out[1].aux == 0x55663344u);
+        CHECK(out[0].timestampNs > 0 && out[1].timestampNs >= out[0].timestampNs);
+        CHECK(d.drain(out, 4) == 0);
+    }
+
+    void ringOverwritesOldest()
+    {
+        ctx = ecx_contextt();
+        std::mutex ctxLock;
+        Diagnostics d(&ctx, ctxLock);
+        d.configure(ringOf(4));
+        for (int i = 0; i < 6; i++)
+            pushSdoAbort(1, i);
+        d.collectErrors();
+
+        Diagnostics::Stats st = d.stats();
+        CHECK(st.capacity == 4);
+        CHECK(st.pending == 4);
+        CHECK(st.recorded == 6);
+        CHECK(st.overwritten == 2);
+
+        // Oldest first, across two partial drains and the ring wrap.
+        Diagnostics::Record out[4];
+        CHECK(d.drain(out, 3) == 3);
+        CHECK(out[0].code == 2 && out[1].code == 3 && out[2].code == 4);
+        pushSdoAbort(1, 6);
+        d.collectErrors();
+        CHECK(d.drain(out, 4) == 2);
+        CHECK(out[0].code == 5 && out[1].code == 6);
+        CHECK(d.stats().pending == 0);
+    }
+
+    void busyLockLeavesErrorsQueued()
+    {
+        ctx = ecx_contextt();
+        std::mutex ctxLock;
+        Diagnostics d(&ctx, ctxLock);
+        d.configure(ringOf(8));
+        pushSdoAbort(1, 1);
+        {
+            std::lock_guard<std::mutex> hold(ctxLock);
+            d.collectErrors();
+        }
+        CHECK(d.stats().recorded == 0);
+        CHECK(ecx_iserror(&ctx));
+        d.collectErrors();
+        CHECK(d.stats().recorded == 1);
+    }
+
+    void resizeClearsRing()
+    {
+        ctx = ecx_contextt();
+        std::mutex ctxLock;
+        Diagnostics d(&ctx, ctxLock);
+        d.configure(ringOf(8));
+        pushSdoAbort(1, 1);
+        d.collectErrors();
+        d.configure(ringOf(2));
+        Diagnostics::Stats st = d.stats();
+        CHECK(st.capacity == 2);
+        CHECK(st.pending == 0);
+    }
+
+} // namespace
+
+int main()
+{
+    errorListToRecords();
+    ringOverwritesOldest();
+    busyLockLeavesErrorsQueued();
+    resizeClearsRing();
+    return soemnode_test::checkResult("diagnostics_test");
+}
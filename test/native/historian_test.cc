@@ -0,0 +1,221 @@
+// Historian: record -> segments on disk -> read() roundtrip, including
+// segment rotation, time sub-ranges and records longer than one RLE token.
+
+#include "check.hpp"
+#include "historian.hpp"
+
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace soemnode;
+namespace fs = std::filesystem;
+
+namespace
+{
+
+    int64_t steadyNow()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int64_t wallNow()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    fs::path scratchDir(const char *name)
+    {
+        fs::path dir = fs::temp_directory_path() / (std::string("soem-node-") + name + "-" + std::to_string(steadyNow()));
+        fs::remove_all(dir);
+        return dir;
+    }
+
+    // 32-byte image: a counter, a slowly changing word and constant padding,
+    // which gives zero runs, literals and unchanged records.
+    void fillImage(uint8_t *image, uint32_t i)
+    {
+        std::memset(image, 0, 32);
+        std::memcpy(image, &i, sizeof(i));
+        uint32_t slow = i / 100;
+        std::memcpy(image + 16, &slow, sizeof(slow));
+        image[24] = 0x5A;
+    }
+
+    void roundtripWithRotation()
+    {
+        fs::path dir = scratchDir("hist");
+        Historian::Options opt;
+        opt.dir = dir.string();
+        opt.ranges = {{0, 8}, {16, 12}};
+        opt.segmentBytes = 16 * 1024;
+        opt.maxSegments = 1000;
+        opt.blockRecords = 100;
+        opt.ringRecords = 8192;
+        opt.flushIntervalMs = 10;
+
+        const uint32_t count = 5000;
+        const int64_t step = 1000000; // 1 ms
+        Historian h;
+        std::string err;
+        CHECK(h.start(opt, err));
+        CHECK(h.recordSize() == 20);
+        int64_t base = steadyNow();
+        int64_t wallAtBase = wallNow();
+        uint8_t image[32];
+        for (uint32_t i = 0; i < count; i++)
+        {
+            fillImage(image, i);
+            h.record(base + i * step, static_cast<int32_t>(i % 7), image);
+        }
+        h.stop();
+        Historian::Stats st = h.stats();
+        CHECK(st.recorded == count);
+        CHECK(st.dropped == 0);
+        CHECK(st.segment > 0);
+
+        Historian::Result all;
+        CHECK(Historian::read(opt.dir, INT64_MIN, INT64_MAX, 0, all, err));
+        CHECK(all.recordSize == 20);
+        CHECK(all.timestamps.size() == count);
+        CHECK(all.wkc.size() == count);
+        CHECK(all.data.size() == static_cast<size_t>(count) * 20);
+        if (all.timestamps.size() == count && all.data.size() == static_cast<size_t>(count) * 20)
+        {
+            // Wall-clock conversion lands next to when the records were made.
+            int64_t skew = all.timestamps[0] - wallAtBase;
+            CHECK(skew > -1000000000LL && skew < 1000000000LL);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                fillImage(image, i);
+                const uint8_t *rec = all.data.data() + static_cast<size_t>(i) * 20;
+                if (std::memcmp(rec, image, 8) != 0 || std::memcmp(rec + 8, image + 16, 12) != 0)
+                {
+                    CHECK(!"record content");
+                    break;
+                }
+                // Segments sample the clock pair on creation, so steps across a
+                // segment boundary may differ by the sampling error.
+                int64_t jitter = i ? all.timestamps[i] - all.timestamps[i - 1] - step : 0;
+                if (all.wkc[i] != static_cast<int32_t>(i % 7) || jitter < -100000 || jitter > 100000)
+                {
+                    CHECK(!"record timestamp / wkc");
+                    break;
+                }
+            }
+
+            // Sub-range spanning several blocks and segments.
+            Historian::Result part;
+            CHECK(Historian::read(opt.dir, all.timestamps[1000], all.timestamps[2999], 0, part, err));
+            CHECK(part.timestamps.size() == 2000);
+            if (!part.timestamps.empty())
+            {
+                CHECK(part.timestamps.front() == all.timestamps[1000]);
+                CHECK(part.timestamps.back() == all.timestamps[2999]);
+                CHECK(std::memcmp(part.data.data(), all.data.data() + 1000 * 20, part.data.size()) == 0);
+            }
+
+            Historian::Result capped;
+            CHECK(Historian::read(opt.dir, all.timestamps[4000], INT64_MAX, 10, capped, err));
+            CHECK(capped.timestamps.size() == 10);
+
+            Historian::Result none;
+            CHECK(Historian::read(opt.dir, all.timestamps[count - 1] + 1, INT64_MAX, 0, none, err));
+            CHECK(none.timestamps.empty());
+        }
+        fs::remove_all(dir);
+    }
+
+    void longRecords()
+    {
+        // Zero runs and literals longer than the 16-bit token limit.
+        const uint32_t size = 150000;
+        fs::path dir = scratchDir("hist-long");
+        Historian::Options opt;
+        opt.dir = dir.string();
+        opt.ranges = {{0, size}};
+        opt.segmentBytes = 4 * 1024 * 1024;
+        opt.blockRecords = 4;
+        Historian h;
+        std::string err;
+        CHECK(h.start(opt, err));
+        std::vector<std::vector<uint8_t>> images(3, std::vector<uint8_t>(size, 0));
+        for (uint32_t i = 0; i < size; i++)
+            images[1][i] = static_cast<uint8_t>(i * 31 + 7) | 1;
+        images[2] = images[1];
+        images[2][size - 1] ^= 0xFF;
+        int64_t base = steadyNow();
+        for (size_t r = 0; r < images.size(); r++)
+            h.record(base + static_cast<int64_t>(r), 1, images[r].data());
+        h.stop();
+
+        Historian::Result res;
+        CHECK(Historian::read(opt.dir, INT64_MIN, INT64_MAX, 0, res, err));
+        CHECK(res.timestamps.size() == images.size());
+        if (res.data.size() == images.size() * size)
+        {
+            for (size_t r = 0; r < images.size(); r++)
+                CHECK(std::memcmp(res.data.data() + r * size, images[r].data(), size) == 0);
+        }
+        fs::remove_all(dir);
+    }
+
+    void damagedBlockCount()
+    {
+        // A block whose count does not fit its payload is skipped; the
+        // blocks after it are still read.
+        fs::path dir = scratchDir("hist-damaged");
+        Historian::Options opt;
+        opt.dir = dir.string();
+        opt.ranges = {{0, 8}};
+        opt.blockRecords = 10;
+        Historian h;
+        std::string err;
+        CHECK(h.start(opt, err));
+        int64_t base = steadyNow();
+        uint8_t image[32];
+        for (uint32_t i = 0; i < 30; i++)
+        {
+            fillImage(image, i);
+            h.record(base + i, 1, image);
+        }
+        h.stop();
+
+        std::vector<fs::path> segments;
+        for (const fs::directory_entry &e : fs::directory_iterator(dir))
+            segments.push_back(e.path());
+        CHECK(segments.size() == 1);
+        if (segments.size() == 1)
+        {
+            // First block right after the 64-byte segment header; count at +4.
+            std::fstream f(segments[0], std::ios::in | std::ios::out | std::ios::binary);
+            uint32_t count = 0xFFFFFFFFu;
+            f.seekp(64 + 4);
+            f.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        }
+
+        Historian::Result res;
+        CHECK(Historian::read(opt.dir, INT64_MIN, INT64_MAX, 0, res, err));
+        CHECK(res.timestamps.size() == 20);
+        if (res.data.size() == 20 * 8)
+        {
+            uint32_t first;
+            std::memcpy(&first, res.data.data(), sizeof(first));
+            CHECK(first == 10);
+        }
+        fs::remove_all(dir);
+    }
+
+} // namespace
+
+int main()
+{
+    roundtripWithRotation();
+    longRecords();
+    damagedBlockCount();
+    return soemnode_test::checkResult("historian_test");
+}
@@ -0,0 +1,116 @@
+// Group IOmap sizing and re-layout for images larger than the initial 8 KiB
+// map. The layout SOEM would produce is written by hand, so no bus is needed.
+
+#include "check.hpp"
+#include "iomap.hpp"
+
+#include <cstring>
+#include <vector>
+
+using namespace soemnode;
+
+namespace
+{
+
+    ecx_contextt ctx;
+
+    const int kSlaves = 40;
+    const uint16 kBytes = 128;
+
+    // kSlaves slaves with kBytes of outputs and inputs each (10 KiB in
+    // total); odd slaves are in group 1, even slaves in group 2.
+    void configureSlaves()
+    {
+        ctx = ecx_contextt();
+        ctx.slavecount = kSlaves;
+        for (int s = 1; s <= kSlaves; s++)
+        {
+            ec_slavet &sl = ctx.slavelist[s];
+            sl.group = static_cast<uint8>(s % 2 ? 1 : 2);
+            sl.SMtype[2] = 3;
+            sl.SM[2].SMlength = kBytes;
+            sl.SMtype[3] = 4;
+            sl.SM[3].SMlength = kBytes;
+        }
+    }
+
+    // Outputs of every slave, then inputs, as ecx_config_map_group lays
+    // group 0 out from base.
+    void layOut(uint8 *base)
+    {
+        ctx.grouplist[0].outputs = base;
+        ctx.grouplist[0].inputs = base + kSlaves * kBytes;
+        for (int s = 1; s <= kSlaves; s++)
+        {
+            ctx.slavelist[s].outputs = base + (s - 1) * kBytes;
+            ctx.slavelist[s].inputs = base + (kSlaves + s - 1) * kBytes;
+        }
+    }
+
+    void estimateCoversLargeImage()
+    {
+        configureSlaves();
+        size_t image = 2u * kSlaves * kBytes;
+        size_t all = groupIOmapEstimate(&ctx, 0);
+        CHECK(image > 8192);
+        CHECK(all >= image);
+        // Per-slave padding only, no more.
+        CHECK(all <= image + 2 * kSlaves);
+        CHECK(groupIOmapEstimate(&ctx, 1) >= image / 2);
+        CHECK(groupIOmapEstimate(&ctx, 1) < all);
+        CHECK(groupIOmapEstimate(&ctx, 3) == 0);
+    }
+
+    void estimateUsesPreviousMapping()
+    {
+        // A CoE slave whose PDO assignment grew past its SII defaults.
+        configureSlaves();
+        ctx.slavecount = 1;
+        ctx.slavelist[1].Obits = 8 * 1000 + 1;
+        CHECK(groupIOmapEstimate(&ctx, 0) >= 1001 + kBytes);
+    }
+
+    void rebaseLargeImage()
+    {
+        configureSlaves();
+        std::vector<uint8> small(8192);
+        layOut(small.data());
+        std::vector<uint8> grown(2u * kSlaves * kBytes);
+        rebaseGroupIOmap(&ctx, 0, small.data(), grown.size(), grown.data());
+        CHECK(ctx.grouplist[0].outputs == grown.data());
+        CHECK(ctx.grouplist[0].inputs == grown.data() + kSlaves * kBytes);
+        bool moved = true;
+        for (int s = 1; s <= kSlaves; s++)
+        {
+            // Including the pointers past the end of the 8 KiB map.
+            moved = moved && ctx.slavelist[s].outputs == grown.data() + (s - 1) * kBytes;
+            moved = moved && ctx.slavelist[s].inputs == grown.data() + (kSlaves + s - 1) * kBytes;
+        }
+        CHECK(moved);
+    }
+
+    void rebaseLeavesOtherGroups()
+    {
+        configureSlaves();
+        std::vector<uint8> map1(4096);
+        layOut(map1.data());
+        uint8 *slave2Out = ctx.slavelist[2].outputs;
+        uint8 *group0Out = ctx.grouplist[0].outputs;
+        std::vector<uint8> grown(2u * kSlaves * kBytes);
+        rebaseGroupIOmap(&ctx, 1, map1.data(), grown.size(), grown.data());
+        CHECK(ctx.slavelist[1].outputs == grown.data());
+        CHECK(ctx.slavelist[3].outputs == grown.data() + 2 * kBytes);
+        CHECK(ctx.slavelist[2].outputs == slave2Out);
+        CHECK(ctx.grouplist[0].outputs == group0Out);
+    }
+
+} // namespace
+
+int main()
+{
+    estimateCoversLargeImage();
+    estimateUsesPreviousMapping();
+    rebaseLargeImage();
+    rebaseLeavesOtherGroups();
+    return soemnode_test::checkResult("iomap_test");
+}
@@ -0,0 +1,195 @@
+// MailboxScheduler: window gating, priorities, overrun accounting and stop().
+// Jobs only record how they were run, so no bus is needed. Periods are in
+// tens of milliseconds to keep the timing checks stable on loaded CI runners.
+
+#include "check.hpp"
+#include "mailbox_scheduler.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace soemnode;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+    ecx_contextt ctx;
+
+    struct Log
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::vector<int> ran;     // job ids in run order
+        std::vector<int> windows; // windowUs seen by each run
+        std::vector<int> done;    // job ids handed back, run or not
+
+        bool waitDone(size_t count, int ms)
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            return cv.wait_for(lock, std::chrono::milliseconds(ms), [&]
+                               { return done.size() >= count; });
+        }
+
+        size_t doneCount()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            return done.size();
+        }
+    };
+
+    struct TestJob : MailboxScheduler::Job
+    {
+        TestJob(Log &log, int id, MailboxScheduler::Priority prio, int sleepMs = 0) : log(log), id(id), sleepMs(sleepMs)
+        {
+            priority = prio;
+        }
+
+        void run(ecx_contextt *, int windowUs) override
+        {
+            if (sleepMs)
+                std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+            std::lock_guard<std::mutex> lock(log.mtx);
+            log.ran.push_back(id);
+            log.windows.push_back(windowUs);
+        }
+
+        Log &log;
+        int id;
+        int sleepMs;
+    };
+
+    MailboxScheduler::DoneFn collect(Log &log)
+    {
+        return [&log](MailboxScheduler::Job *j)
+        {
+            TestJob *job = static_cast<TestJob *>(j);
+            {
+                std::lock_guard<std::mutex> lock(log.mtx);
+                log.done.push_back(job->id);
+            }
+            log.cv.notify_all();
+            delete job;
+        };
+    }
+
+    std::unique_ptr<MailboxScheduler::Job> job(Log &log, int id, MailboxScheduler::Priority prio = MailboxScheduler::PRIO_NORMAL, int sleepMs = 0)
+    {
+        return std::unique_ptr<MailboxScheduler::Job>(new TestJob(log, id, prio, sleepMs));
+    }
+
+    MailboxScheduler::Config windowed(uint32_t budgetUs)
+    {
+        MailboxScheduler::Config cfg;
+        cfg.periodUs = 200000;
+        cfg.budgetUs = budgetUs;
+        cfg.guardUs = 10000;
+        cfg.maxPerCycle = 1;
+        cfg.idleAfterUs = 10000000;
+        return cfg;
+    }
+
+    void idleBusServesByPriority()
+    {
+        Log log;
+        std::mutex ctxLock;
+        MailboxScheduler s(&ctx, ctxLock, collect(log));
+        {
+            // The first job is taken at once and blocks on the context lock,
+            // so the next two are queued together.
+            std::lock_guard<std::mutex> hold(ctxLock);
+            s.submit(job(log, 1));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            s.submit(job(log, 2, MailboxScheduler::PRIO_LOW));
+            s.submit(job(log, 3, MailboxScheduler::PRIO_HIGH));
+        }
+        CHECK(log.waitDone(3, 2000));
+        CHECK((log.ran == std::vector<int>{1, 3, 2}));
+        // No cycle was ever reported: the bus is idle and jobs get no window.
+        for (int w : log.windows)
+            CHECK(w == -1);
+        MailboxScheduler::Stats st = s.stats();
+        CHECK(st.served[MailboxScheduler::PRIO_HIGH] == 1);
+        CHECK(st.served[MailboxScheduler::PRIO_NORMAL] == 1);
+        CHECK(st.served[MailboxScheduler::PRIO_LOW] == 1);
+    }
+
+    void grantsFollowCycles()
+    {
+        Log log;
+        std::mutex ctxLock;
+        MailboxScheduler s(&ctx, ctxLock, collect(log));
+        s.configure(windowed(50000));
+
+        // Cycle that ends too close to the next one: nothing may start.
+        auto now = Clock::now();
+        s.cycleDone(now - std::chrono::milliseconds(180), now);
+        s.submit(job(log, 1));
+        s.submit(job(log, 2));
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        CHECK(log.doneCount() == 0);
+        CHECK(s.stats().skippedCycles == 1);
+
+        // One grant per cycle.
+        now = Clock::now();
+        s.cycleDone(now, now);
+        CHECK(log.waitDone(1, 1000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        CHECK(log.doneCount() == 1);
+        now = Clock::now();
+        s.cycleDone(now, now);
+        CHECK(log.waitDone(2, 1000));
+
+        CHECK(log.windows.size() == 2);
+        for (int w : log.windows)
+            CHECK(w >= 0 && w <= 50000);
+        MailboxScheduler::Stats st = s.stats();
+        CHECK(st.cycles == 3);
+        CHECK(st.overruns == 0);
+    }
+
+    void overrunsAreCounted()
+    {
+        Log log;
+        std::mutex ctxLock;
+        MailboxScheduler s(&ctx, ctxLock, collect(log));
+        s.configure(windowed(5000));
+        auto now = Clock::now();
+        s.cycleDone(now, now);
+        s.submit(job(log, 1, MailboxScheduler::PRIO_NORMAL, 40));
+        CHECK(log.waitDone(1, 2000));
+        // done_ runs before the stats are updated.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        MailboxScheduler::Stats st = s.stats();
+        CHECK(st.overruns == 1);
+        CHECK(st.maxOverrunUs >= 20000);
+    }
+
+    void stopHandsBackQueuedJobs()
+    {
+        Log log;
+        std::mutex ctxLock;
+        MailboxScheduler s(&ctx, ctxLock, collect(log));
+        s.configure(windowed(50000));
+        auto now = Clock::now();
+        s.cycleDone(now - std::chrono::milliseconds(180), now);
+        s.submit(job(log, 1));
+        s.submit(job(log, 2, MailboxScheduler::PRIO_HIGH));
+        s.stop();
+        CHECK(log.ran.empty());
+        CHECK(log.done.size() == 2);
+    }
+
+} // namespace
+
+int main()
+{
+    idleBusServesByPriority();
+    grantsFollowCycles();
+    overrunsAreCounted();
+    stopHandsBackQueuedJobs();
+    return soemnode_test::checkResult("mailbox_scheduler_test");
+}
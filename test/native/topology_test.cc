@@ -0,0 +1,136 @@
+// Topology diff: matching scanned positions to the configured slaves and
+// deciding whether the change can be handled by configNewSlaves. Scans are
+// built by hand, so no bus is needed.
+
+#include "check.hpp"
+#include "topology.hpp"
+
+#include <string>
+
+using namespace soemnode;
+
+namespace
+{
+
+    ecx_contextt ctx;
+
+    // Two configured slaves at their default station addresses.
+    void configureTwo()
+    {
+        ctx = ecx_contextt();
+        ctx.slavecount = 2;
+        for (int s = 1; s <= 2; s++)
+        {
+            ctx.slavelist[s].configadr = static_cast<uint16>(EC_NODEOFFSET + s);
+            ctx.slavelist[s].eep_man = 0x2;
+            ctx.slavelist[s].eep_id = 0x1000 + s;
+            ctx.slavelist[s].eep_rev = s;
+        }
+    }
+
+    TopologyScan scanOf(std::initializer_list<uint16> addresses)
+    {
+        TopologyScan scan;
+        uint16 pos = 1;
+        for (uint16 adr : addresses)
+        {
+            TopologyEntry e;
+            e.position = pos++;
+            e.configadr = adr;
+            scan.entries.push_back(e);
+        }
+        scan.busCount = static_cast<int>(scan.entries.size());
+        return scan;
+    }
+
+    void appendedSlave()
+    {
+        configureTwo();
+        TopologyScan scan = scanOf({EC_NODEOFFSET + 1, EC_NODEOFFSET + 2, 0});
+        matchTopology(&ctx, scan);
+        CHECK(scan.removed.empty());
+        CHECK(scan.entries[0].slave == 1 && scan.entries[1].slave == 2);
+        CHECK(scan.entries[1].identified && scan.entries[1].productCode == 0x1002);
+        CHECK(scan.entries[2].slave == 0 && !scan.entries[2].identified);
+        std::string err;
+        CHECK(appendedSlaveCount(ctx.slavecount, scan, err) == 1);
+        CHECK(err.empty());
+    }
+
+    void unchangedBus()
+    {
+        configureTwo();
+        TopologyScan scan = scanOf({EC_NODEOFFSET + 1, EC_NODEOFFSET + 2});
+        matchTopology(&ctx, scan);
+        std::string err;
+        CHECK(appendedSlaveCount(ctx.slavecount, scan, err) == 0);
+    }
+
+    void removedSlave()
+    {
+        configureTwo();
+        TopologyScan scan = scanOf({EC_NODEOFFSET + 1, 0});
+        matchTopology(&ctx, scan);
+        CHECK(scan.removed.size() == 1 && scan.removed[0] == 2);
+        std::string err;
+        CHECK(appendedSlaveCount(ctx.slavecount, scan, err) == -1);
+        CHECK(err == "configured slaves are missing from the bus");
+    }
+
+    void reorderedSlaves()
+    {
+        configureTwo();
+        TopologyScan scan = scanOf({EC_NODEOFFSET + 2, EC_NODEOFFSET + 1, 0});
+        matchTopology(&ctx, scan);
+        CHECK(scan.removed.empty());
+        std::string err;
+        CHECK(appendedSlaveCount(ctx.slavecount, scan, err) == -1);
+        CHECK(err == "bus order changed at position 1");
+    }
+
+    void duplicateAddress()
+    {
+        // A slave moved from another bus keeps its old station address; it
+        // must not be taken for the configured slave answering first.
+        configureTwo();
+        TopologyScan scan = scanOf({EC_NODEOFFSET + 1, EC_NODEOFFSET + 2, EC_NODEOFFSET + 1});
+        matchTopology(&ctx, scan);
+        CHECK(scan.entries[0].slave == 1);
+        CHECK(scan.entries[2].slave == 0);
+        std::string err;
+        CHECK(appendedSlaveCount(ctx.slavecount, scan, err) == 1);
+    }
+
+    void nothingConfigured()
+    {
+        ctx = ecx_contextt();
+        TopologyScan scan = scanOf({0, 0});
+        matchTopology(&ctx, scan);
+        CHECK(scan.removed.empty());
+        std::string err;
+        CHECK(appendedSlaveCount(ctx.slavecount, scan, err) == -1);
+        CHECK(err == "no configured slaves, run configInit first");
+    }
+
+    void openPorts()
+    {
+        // Two bits per port: 0b10 is communication up with the loop open.
+        CHECK(topologyOpenPorts(0x0A00) == 0x03);
+        CHECK(topologyOpenPorts(0x2A00) == 0x07);
+        CHECK(topologyOpenPorts(0x0B00) == 0x02);
+        CHECK(topologyOpenPorts(0) == 0);
+    }
+
+} // namespace
+
+int main()
+{
+    appendedSlave();
+    unchangedBus();
+    removedSlave();
+    reorderedSlaves();
+    duplicateAddress();
+    nothingConfigured();
+    openPorts();
+    return soemnode_test::checkResult("topology_test");
+}
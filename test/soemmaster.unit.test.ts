@@ -10,6 +10,7 @@ const configMapPDOMock = jest.fn(() => undefined);
 const stateMock = jest.fn(() => 4);
 const readStateMock = jest.fn(() => 4);
 const sdoReadMock = jest.fn(() => Buffer.from([0x01, 0x02]));
+const sdoReadIntoMock = jest.fn(() => 2);
 const sdoWriteMock = jest.fn(() => true);
 const sendPDMock = jest.fn(() => 123);
 const receivePDMock = jest.fn(() => 1);
@@ -21,13 +22,56 @@ const recoverSlaveMock = jest.fn(() => 1);
 const slaveMbxCyclicMock = jest.fn(() => 0);
 const configDCMock = jest.fn(() => true);
 const getSlavesMock = jest.fn(() => [{ name: 'slave1' }] );
+const scanTopologyMock = jest.fn(() => ({
+  slaveCount: 3,
+  configuredCount: 2,
+  slaves: [
+    { position: 1, slave: 1, configadr: 0x1001, aliasadr: 0, vendorId: 2, productCode: 0x10, revision: 1, state: 8, ALstatuscode: 0, dlStatus: 0x0a30, linkPorts: 3, openPorts: 3 },
+    { position: 2, slave: 2, configadr: 0x1002, aliasadr: 0, vendorId: 2, productCode: 0x11, revision: 1, state: 8, ALstatuscode: 0, dlStatus: 0x0a30, linkPorts: 3, openPorts: 3 },
+    { position: 3, slave: 0, configadr: 0, aliasadr: 0, vendorId: 2, productCode: 0x12, revision: 1, state: 1, ALstatuscode: 0, dlStatus: 0x0e10, linkPorts: 1, openPorts: 1 }
+  ],
+  added: [3],
+  removed: []
+}));
+const configNewSlavesMock = jest.fn(() => Promise.resolve({ added: 1, group: 1, firstSlave: 3, lastSlave: 3, logicalStart: 64, ioMapBytes: 4, outputsBytes: 2, inputsBytes: 2, expectedWkc: 3 }));
+const slaveIdentityMock = jest.fn(() => ({ vendorId: 0x2, productCode: 0x1234, revision: 0x10 }));
+const readObjectDictionaryMock = jest.fn(() => Promise.resolve({
+  vendorId: 0x2, productCode: 0x1234, revision: 0x10,
+  objects: [{ index: 0x1000, dataType: 7, objectCode: 7, maxSub: 0, name: 'Device type', entries: [] }]
+}));
 const initRedundantMock = jest.fn(() => true);
+const redundancyStatusMock = jest.fn(() => ({
+  enabled: true, lineBreak: true, lineBreaks: 1, cycles: 100, primaryFrames: 100, secondaryFrames: 100,
+  lostFrames: 0, lastFailoverCycles: 1, maxFailoverCycles: 1, lastFailoverUs: 2000, maxFailoverUs: 2000
+}));
 const configMapGroupMock = jest.fn(() => Buffer.from([0x00]));
 const sendProcessdataGroupMock = jest.fn(() => 10);
 const receiveProcessdataGroupMock = jest.fn(() => 11);
+const exchangeMock = jest.fn((_o: unknown, _i: unknown, status: Int32Array) => { status[0] = 3; status[1] = 3; });
+const processImageLayoutMock = jest.fn(() => ({ outputsBytes: 4, inputsBytes: 6, expectedWkc: 3 }));
 const mbxHandlerMock = jest.fn(() => 0);
+const configureMailboxMock = jest.fn(() => undefined);
+const mailboxSubmitMock = jest.fn((req: { type: string }) => Promise.resolve(req.type === 'sdoRead' ? Buffer.from([0x2a]) : true));
+const mailboxStatusMock = jest.fn(() => ({ queued: [0, 0, 0], served: [1, 1, 0], cycles: 10, skippedCycles: 0, overruns: 1, maxOverrunUs: 420 }));
+const startHistorianMock = jest.fn(() => true);
+const stopHistorianMock = jest.fn(() => undefined);
+const historianStatusMock = jest.fn(() => ({ running: true, recordSize: 8, recorded: 2000, dropped: 0, blocks: 2, bytesWritten: 4096, segment: 0 }));
+const readHistoryMock = jest.fn(() => Promise.resolve({ recordSize: 8, timestamps: new BigInt64Array([1n, 2n]), wkc: new Int32Array([3, 3]), data: Buffer.alloc(16) }));
+const configureDiagnosticsMock = jest.fn(() => undefined);
+const drainDiagnosticsMock = jest.fn((target: Uint8Array) => {
+  // one SDO abort record from slave 2
+  const v = new DataView(target.buffer, target.byteOffset, target.byteLength);
+  v.setBigInt64(0, 1000n, true);
+  v.setUint16(8, 2, true);
+  v.setUint16(10, 0, true);
+  v.setUint32(12, 0x06020000, true);
+  v.setInt32(16, (0x1018 << 8) | 1, true);
+  return 1;
+});
+const diagnosticsStatusMock = jest.fn(() => ({ running: true, capacity: 1024, pending: 0, recorded: 1, overwritten: 0, counterPolls: 5 }));
 const elist2stringMock = jest.fn(() => 'no errors');
 const SoEreadMock = jest.fn(() => Buffer.from([0xAA]));
+const SoEreadIntoMock = jest.fn(() => 1);
 const SoEwriteMock = jest.fn(() => true);
 const readeepromMock = jest.fn(() => 0);
 const writeeepromMock = jest.fn(() => 0);
@@ -40,6 +84,12 @@ const dcsync0Mock = jest.fn(() => true);
 const dcsync01Mock = jest.fn(() => true);
 const listInterfacesMock = jest.fn(() => [{ name: 'eth0', description: 'mock' }]);
 
+const legacyConfigMapMock = jest.fn(() => 6);
+const legacyReceivePDMock = jest.fn(() => 3);
+const legacySetTimeoutsMock = jest.fn();
+const legacyGetMapMock = jest.fn(() => new ArrayBuffer(6));
+const legacyGetExpectedWCMock = jest.fn(() => 3);
+
 // Mock the native addon module used by src/index.ts
 jest.mock('../build/Release/soem_addon.node', () => {
   // constructor spy
@@ -50,6 +100,7 @@ jest.mock('../build/Release/soem_addon.node', () => {
     state: stateMock,
     readState: readStateMock,
     sdoRead: sdoReadMock,
+    sdoReadInto: sdoReadIntoMock,
     sdoWrite: sdoWriteMock,
     sendProcessdata: sendPDMock,
     receiveProcessdata: receivePDMock,
@@ -61,13 +112,30 @@ jest.mock('../build/Release/soem_addon.node', () => {
     slaveMbxCyclic: slaveMbxCyclicMock,
     configDC: configDCMock,
     getSlaves: getSlavesMock,
+    scanTopology: scanTopologyMock,
+    configNewSlaves: configNewSlavesMock,
+    slaveIdentity: slaveIdentityMock,
+    readObjectDictionary: readObjectDictionaryMock,
     initRedundant: initRedundantMock,
+    redundancyStatus: redundancyStatusMock,
     configMapGroup: configMapGroupMock,
     sendProcessdataGroup: sendProcessdataGroupMock,
     receiveProcessdataGroup: receiveProcessdataGroupMock,
+    exchange: exchangeMock,
+    processImageLayout: processImageLayoutMock,
     mbxHandler: mbxHandlerMock,
+    configureMailbox: configureMailboxMock,
+    mailboxSubmit: mailboxSubmitMock,
+    mailboxStatus: mailboxStatusMock,
+    startHistorian: startHistorianMock,
+    stopHistorian: stopHistorianMock,
+    historianStatus: historianStatusMock,
     elist2string: elist2stringMock,
+    configureDiagnostics: configureDiagnosticsMock,
+    drainDiagnostics: drainDiagnosticsMock,
+    diagnosticsStatus: diagnosticsStatusMock,
     SoEread: SoEreadMock,
+    SoEreadInto: SoEreadIntoMock,
     SoEwrite: SoEwriteMock,
     readeeprom: readeepromMock,
     writeeeprom: writeeepromMock,
@@ -81,10 +149,24 @@ jest.mock('../build/Release/soem_addon.node', () => {
   }));
   // attach static helper
   (ctor as any).listInterfaces = listInterfacesMock;
-  return { Master: ctor };
+  (ctor as any).readHistory = readHistoryMock;
+  const legacyCtor = jest.fn().mockImplementation(() => ({
+    init: jest.fn(() => 1),
+    configMap: legacyConfigMapMock,
+    sendProcessdata: jest.fn(() => 1),
+    receiveProcessdata: legacyReceivePDMock,
+    getMap: legacyGetMapMock,
+    getExpectedWC: legacyGetExpectedWCMock,
+    setTimeouts: legacySetTimeoutsMock,
+    close: jest.fn()
+  }));
+  return { Master: ctor, NodeSoemMaster: legacyCtor };
 });
 
-import { SoemMaster } from '../src/index';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { SoemMaster, NodeSoemMaster, ExchangeStatus, DiagnosticRecord, DiagnosticType } from '../src/index';
 
 describe('SoemMaster (unit)', () => {
   beforeEach(() => {
@@ -120,10 +202,74 @@ describe('SoemMaster (unit)', () => {
     expect(sdoWriteMock).toHaveBeenCalled();
   });
 
+  it('large SDO / SoE reads with maxSize and into caller buffers', () => {
+    const m = new SoemMaster();
+    m.sdoRead(1, 0x2000, 0, true, 1 << 20);
+    expect(sdoReadMock).toHaveBeenCalledWith(1, 0x2000, 0, true, 1 << 20);
+    const target = Buffer.alloc(16);
+    expect(m.sdoReadInto(1, 0x2000, 0, target, 4)).toBe(2);
+    expect(sdoReadIntoMock).toHaveBeenCalledWith(1, 0x2000, 0, target, 4, false);
+    m.SoEread(1, 0, 0x40, 1, 8192);
+    expect(SoEreadMock).toHaveBeenCalledWith(1, 0, 0x40, 1, 8192);
+    expect(m.SoEreadInto(1, 0, 0x40, 1, target)).toBe(1);
+    expect(SoEreadIntoMock).toHaveBeenCalledWith(1, 0, 0x40, 1, target, 0);
+  });
+
+  it('readObjectDictionary scans once per identity and persists the result', async () => {
+    const cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'soem-od-'));
+    try {
+      SoemMaster.clearObjectDictionaryCache();
+      const a = new SoemMaster();
+      const b = new SoemMaster();
+      const [odA, odB] = await Promise.all([
+        a.readObjectDictionary(1, { cacheDir }),
+        b.readObjectDictionary(2, { cacheDir })
+      ]);
+      expect(readObjectDictionaryMock).toHaveBeenCalledTimes(1);
+      expect(odA.objects[0].index).toBe(0x1000);
+      expect(odB).toBe(odA);
+      expect(fs.existsSync(path.join(cacheDir, '00000002-00001234-00000010.json'))).toBe(true);
+
+      // A fresh process only has the disk cache
+      SoemMaster.clearObjectDictionaryCache();
+      const od = await new SoemMaster().readObjectDictionary(3, { cacheDir });
+      expect(readObjectDictionaryMock).toHaveBeenCalledTimes(1);
+      expect(od.objects[0].name).toBe('Device type');
+
+      await a.readObjectDictionary(1, { cacheDir, refresh: true });
+      expect(readObjectDictionaryMock).toHaveBeenCalledTimes(2);
+    } finally {
+      fs.rmSync(cacheDir, { recursive: true, force: true });
+    }
+  });
+
+  it('readObjectDictionary does not cache an incomplete scan', async () => {
+    const cacheDir = fs.mkdtempSync(path.join(os.tmpdir(), 'soem-od-'));
+    try {
+      SoemMaster.clearObjectDictionaryCache();
+      (readObjectDictionaryMock as jest.Mock).mockImplementationOnce(() => Promise.resolve({
+        vendorId: 0x2, productCode: 0x1234, revision: 0x10, objects: [], incomplete: true
+      }));
+      const m = new SoemMaster();
+      const partial = await m.readObjectDictionary(1, { cacheDir });
+      expect(partial.incomplete).toBe(true);
+      expect(fs.readdirSync(cacheDir)).toHaveLength(0);
+
+      const od = await m.readObjectDictionary(1, { cacheDir });
+      expect(readObjectDictionaryMock).toHaveBeenCalledTimes(2);
+      expect(od.incomplete).toBeUndefined();
+    } finally {
+      fs.rmSync(cacheDir, { recursive: true, force: true });
+    }
+  });
+
   it('processdata send/receive', () => {
     const m = new SoemMaster();
     expect(m.sendProcessdata()).toBe(123);
     expect(m.receiveProcessdata()).toBe(1);
+    expect(receivePDMock).toHaveBeenLastCalledWith(undefined);
+    m.receiveProcessdata(500);
+    expect(receivePDMock).toHaveBeenLastCalledWith(500);
   });
 
   it('close', () => {
@@ -157,6 +303,27 @@ describe('SoemMaster (unit)', () => {
     expect(m.initRedundant('if1', 'if2')).toBe(true);
   });
 
+  it('scanTopology and configNewSlaves for hot-plugged slaves', async () => {
+    const m = new SoemMaster();
+    const scan = m.scanTopology({ identify: true });
+    expect(scanTopologyMock).toHaveBeenCalledWith({ identify: true });
+    expect(scan?.added).toEqual([3]);
+    const res = await m.configNewSlaves();
+    expect(configNewSlavesMock).toHaveBeenCalledWith(1);
+    expect(res?.firstSlave).toBe(3);
+    expect(res?.logicalStart).toBe(64);
+  });
+
+  it('initRedundant and redundancyStatus forward to the native master', () => {
+    const m = new SoemMaster();
+    expect(m.initRedundant('if1', 'if2')).toBe(true);
+    expect(initRedundantMock).toHaveBeenCalledWith('if1', 'if2');
+    const st = m.redundancyStatus();
+    expect(redundancyStatusMock).toHaveBeenCalledWith();
+    // The wrapper hands back the native object as is, without copying.
+    expect(st).toBe(redundancyStatusMock.mock.results[0].value);
+  });
+
   it('group processdata and mailbox handler', () => {
     const m = new SoemMaster();
     expect(m.configMapGroup()).toBeInstanceOf(Buffer);
@@ -165,9 +332,73 @@ describe('SoemMaster (unit)', () => {
     expect(m.mbxHandler()).toBe(0);
   });
 
+  it('exchange writes WKC into the caller status array', () => {
+    const m = new SoemMaster();
+    const layout = m.processImageLayout();
+    expect(layout).toEqual({ outputsBytes: 4, inputsBytes: 6, expectedWkc: 3 });
+    const outputs = new Uint8Array(layout!.outputsBytes);
+    const inputs = new Uint8Array(layout!.inputsBytes);
+    const status = new Int32Array(ExchangeStatus.LENGTH);
+    m.exchange(outputs, inputs, status, 0, 500);
+    expect(exchangeMock).toHaveBeenCalledWith(outputs, inputs, status, 0, 500);
+    // The same views reach the native side, so results land in the caller's arrays.
+    const call = exchangeMock.mock.calls[0];
+    expect(call[0]).toBe(outputs);
+    expect(call[2]).toBe(status);
+    m.exchange(null, null, status);
+    expect(exchangeMock).toHaveBeenLastCalledWith(null, null, status, 0, undefined);
+  });
+
+  it('ExchangeStatus indexes match the native status layout', () => {
+    expect(ExchangeStatus).toEqual({ WKC: 0, EXPECTED_WKC: 1, ROUNDTRIP_US: 2, EXCHANGE_US: 3, LENGTH: 4 });
+  });
+
+  it('mailbox scheduler maps priorities and forwards requests', async () => {
+    const m = new SoemMaster();
+    m.configureMailbox({ periodUs: 1000, budgetUs: 300, maxPerCycle: 2 });
+    expect(configureMailboxMock).toHaveBeenCalledWith({ periodUs: 1000, budgetUs: 300, maxPerCycle: 2 });
+    const buf = await m.mailbox({ type: 'sdoRead', slave: 1, index: 0x1018, subIndex: 1, priority: 'high' });
+    expect(buf).toEqual(Buffer.from([0x2a]));
+    expect(mailboxSubmitMock).toHaveBeenCalledWith({ type: 'sdoRead', slave: 1, index: 0x1018, subIndex: 1, priority: 0 });
+    const ok = await m.mailbox({ type: 'registerWrite', slave: 1, address: 0x0120, data: Buffer.from([0x02, 0x00]) });
+    expect(ok).toBe(true);
+    expect(mailboxSubmitMock).toHaveBeenLastCalledWith(expect.objectContaining({ type: 'registerWrite', priority: 1 }));
+    expect(m.mailboxStatus().served).toEqual([1, 1, 0]);
+  });
+
+  it('historian start/status/stop and static readHistory', async () => {
+    const m = new SoemMaster();
+    const opts = { dir: '/tmp/hist', ranges: [{ offset: 0, length: 4 }, { offset: 16, length: 4 }], blockRecords: 1000 };
+    expect(m.startHistorian(opts)).toBe(true);
+    expect(startHistorianMock).toHaveBeenCalledWith(opts);
+    expect(m.historianStatus().recorded).toBe(2000);
+    m.stopHistorian();
+    expect(stopHistorianMock).toHaveBeenCalled();
+    const h = await SoemMaster.readHistory('/tmp/hist', 0n, 5n, 10);
+    expect(readHistoryMock).toHaveBeenCalledWith('/tmp/hist', 0n, 5n, 10);
+    expect(h.data.length).toBe(h.recordSize * h.timestamps.length);
+  });
+
+  it('diagnostics ring drains binary records', () => {
+    const m = new SoemMaster();
+    m.configureDiagnostics({ capacity: 256, counterIntervalMs: 500 });
+    expect(configureDiagnosticsMock).toHaveBeenCalledWith({ capacity: 256, counterIntervalMs: 500 });
+    const buf = new Uint8Array(DiagnosticRecord.SIZE * 8);
+    const n = m.drainDiagnostics(buf);
+    expect(n).toBe(1);
+    const v = new DataView(buf.buffer);
+    expect(v.getUint16(DiagnosticRecord.SLAVE, true)).toBe(2);
+    expect(v.getUint16(DiagnosticRecord.TYPE, true)).toBe(DiagnosticType.SDO_ERROR);
+    expect(v.getUint32(DiagnosticRecord.CODE, true)).toBe(0x06020000);
+    expect(m.diagnosticsStatus().counterPolls).toBe(5);
+  });
+
   it('elist2string and SoE read/write', () => {
     const m = new SoemMaster();
     expect(m.elist2string()).toBe('no errors');
+    // Mailbox lock busy: null instead of waiting.
+    elist2stringMock.mockReturnValueOnce(null as unknown as string);
+    expect(m.elist2string()).toBeNull();
     expect(m.SoEread(1, 0, 0, 1)).toBeInstanceOf(Buffer);
     expect(m.SoEwrite(1, 0, 0, 1, Buffer.from([0x1]))).toBe(true);
   });
@@ -198,4 +429,28 @@ describe('SoemMaster (unit)', () => {
     expect(list).toBeInstanceOf(Array);
     expect(list[0].name).toBe('eth0');
   });
+
+  it('NodeSoemMaster passes the interface and timeouts to the native constructor', () => {
+    const native = jest.requireMock('../build/Release/soem_addon.node');
+    new NodeSoemMaster('eth0', { receive: 2000 });
+    expect(native.NodeSoemMaster).toHaveBeenCalledWith('eth0', { receive: 2000 });
+    new NodeSoemMaster('eth1');
+    expect(native.NodeSoemMaster).toHaveBeenLastCalledWith('eth1');
+  });
+
+  it('NodeSoemMaster forwards group and timeout arguments', () => {
+    const m = new NodeSoemMaster('eth0', { receive: 2000 });
+    expect(m.configMap(1)).toBe(6);
+    expect(legacyConfigMapMock).toHaveBeenCalledWith(1);
+    expect(m.getMap(1).byteLength).toBe(6);
+    expect(legacyGetMapMock).toHaveBeenCalledWith(1);
+    expect(m.receiveProcessdata(500, 1)).toBe(3);
+    expect(legacyReceivePDMock).toHaveBeenCalledWith(500, 1);
+    expect(m.receiveProcessdata()).toBe(3);
+    expect(legacyReceivePDMock).toHaveBeenLastCalledWith(undefined, undefined);
+    expect(m.getExpectedWC(1)).toBe(3);
+    expect(legacyGetExpectedWCMock).toHaveBeenCalledWith(1);
+    m.setTimeouts({ statecheck: 2000 });
+    expect(legacySetTimeoutsMock).toHaveBeenCalledWith({ statecheck: 2000 });
+  });
 });
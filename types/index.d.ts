@@ -5,6 +5,231 @@ export interface NetworkInterface {
   description: string;
 }
 
+export interface SlaveIdentity {
+  vendorId: number;
+  productCode: number;
+  revision: number;
+}
+
+export interface ODEntry {
+  subIndex: number;
+  dataType: number;
+  bitLength: number;
+  access: number;
+  name: string;
+}
+
+export interface ODObject {
+  index: number;
+  dataType: number;
+  objectCode: number;
+  maxSub: number;
+  name: string;
+  entries: ODEntry[];
+}
+
+export interface ObjectDictionary extends SlaveIdentity {
+  objects: ODObject[];
+  incomplete?: boolean;
+}
+
+export interface ReadObjectDictionaryOptions {
+  cacheDir?: string | null;
+  refresh?: boolean;
+}
+
+export interface RedundancyStatus {
+  enabled: boolean;
+  lineBreak: boolean;
+  lineBreaks: number;
+  cycles: number;
+  primaryFrames: number;
+  secondaryFrames: number;
+  lostFrames: number;
+  lastFailoverCycles: number;
+  maxFailoverCycles: number;
+  lastFailoverUs: number;
+  maxFailoverUs: number;
+}
+
+export declare const ExchangeStatus: {
+  readonly WKC: 0;
+  readonly EXPECTED_WKC: 1;
+  readonly ROUNDTRIP_US: 2;
+  readonly EXCHANGE_US: 3;
+  readonly LENGTH: 4;
+};
+
+export declare const DiagnosticRecord: {
+  readonly TIMESTAMP: 0;
+  readonly SLAVE: 8;
+  readonly TYPE: 10;
+  readonly CODE: 12;
+  readonly DETAIL: 16;
+  readonly AUX: 20;
+  readonly SIZE: 24;
+};
+
+export declare const DiagnosticType: {
+  readonly SDO_ERROR: 0;
+  readonly EMERGENCY: 1;
+  readonly PACKET_ERROR: 3;
+  readonly SDOINFO_ERROR: 4;
+  readonly FOE_ERROR: 5;
+  readonly FOE_BUF2SMALL: 6;
+  readonly FOE_PACKETNUMBER: 7;
+  readonly SOE_ERROR: 8;
+  readonly MBX_ERROR: 9;
+  readonly FOE_FILE_NOTFOUND: 10;
+  readonly EOE_INVALID_RX_DATA: 11;
+  readonly ESC_RX_ERROR: 0x100;
+  readonly ESC_INVALID_FRAME: 0x101;
+  readonly ESC_FORWARDED_ERROR: 0x102;
+  readonly ESC_PROCESSING_UNIT: 0x103;
+  readonly ESC_PDI_ERROR: 0x104;
+  readonly ESC_LOST_LINK: 0x105;
+  readonly SLAVE_NO_RESPONSE: 0x110;
+  readonly SLAVE_RESPONDING: 0x111;
+};
+
+export interface DiagnosticsOptions {
+  capacity?: number;
+  counterIntervalMs?: number;
+  slavesPerPoll?: number;
+}
+
+export interface DiagnosticsStatus {
+  running: boolean;
+  capacity: number;
+  pending: number;
+  recorded: number;
+  overwritten: number;
+  counterPolls: number;
+}
+
+export interface ProcessImageLayout {
+  outputsBytes: number;
+  inputsBytes: number;
+  expectedWkc: number;
+}
+
+export type MailboxPriority = 'high' | 'normal' | 'low';
+
+export interface MailboxRequestBase {
+  slave: number;
+  priority?: MailboxPriority;
+  timeout?: number;
+}
+
+export type MailboxRequest =
+  | (MailboxRequestBase & { type: 'sdoRead'; index: number; subIndex: number; completeAccess?: boolean; maxSize?: number })
+  | (MailboxRequestBase & { type: 'sdoWrite'; index: number; subIndex: number; data: ArrayBufferView; completeAccess?: boolean })
+  | (MailboxRequestBase & { type: 'soeRead'; driveNo: number; elementFlags: number; idn: number; maxSize?: number })
+  | (MailboxRequestBase & { type: 'soeWrite'; driveNo: number; elementFlags: number; idn: number; data: ArrayBufferView })
+  | (MailboxRequestBase & { type: 'eepromRead'; address: number })
+  | (MailboxRequestBase & { type: 'eepromWrite'; address: number; value: number })
+  | (MailboxRequestBase & { type: 'registerRead'; address: number; length: number })
+  | (MailboxRequestBase & { type: 'registerWrite'; address: number; data: ArrayBufferView });
+
+export type MailboxResult<R extends MailboxRequest> =
+  R extends { type: 'sdoRead' | 'soeRead' | 'registerRead' } ? Buffer | null :
+  R extends { type: 'eepromRead' } ? number | null : boolean;
+
+export interface MailboxSchedulerOptions {
+  periodUs?: number;
+  budgetUs?: number;
+  maxPerCycle?: number;
+  guardUs?: number;
+  idleAfterUs?: number;
+}
+
+export interface MailboxStatus {
+  queued: number[];
+  served: number[];
+  cycles: number;
+  skippedCycles: number;
+  overruns: number;
+  maxOverrunUs: number;
+}
+
+export interface TopologySlave {
+  position: number;
+  slave: number;
+  configadr: number;
+  aliasadr: number;
+  vendorId?: number;
+  productCode?: number;
+  revision?: number;
+  state: number;
+  ALstatuscode: number;
+  dlStatus: number;
+  linkPorts: number;
+  openPorts: number;
+}
+
+export interface TopologyScanOptions {
+  identify?: boolean;
+}
+
+export interface TopologyScan {
+  slaveCount: number;
+  configuredCount: number;
+  slaves: TopologySlave[];
+  added: number[];
+  removed: number[];
+}
+
+export interface NewSlavesResult {
+  added: number;
+  group: number;
+  firstSlave?: number;
+  lastSlave?: number;
+  logicalStart?: number;
+  ioMapBytes?: number;
+  outputsBytes?: number;
+  inputsBytes?: number;
+  expectedWkc?: number;
+  error?: string;
+}
+
+export interface HistorianRange {
+  offset: number;
+  length: number;
+}
+
+export interface HistorianOptions {
+  dir: string;
+  group?: number;
+  ranges?: HistorianRange[];
+  segmentBytes?: number;
+  maxSegments?: number;
+  blockRecords?: number;
+  ringRecords?: number;
+  flushIntervalMs?: number;
+}
+
+export interface HistorianStatus {
+  running: boolean;
+  recordSize: number;
+  recorded: number;
+  dropped: number;
+  blocks: number;
+  bytesWritten: number;
+  segment: number;
+}
+
+export interface HistoryRecords {
+  recordSize: number;
+  timestamps: BigInt64Array;
+  wkc: Int32Array;
+  data: Buffer;
+}
+
+export interface NodeSoemMasterTimeouts {
+  receive?: number;
+  statecheck?: number;
+}
+
 export class SoemMaster {
   constructor(ifname?: IfName);
   init(): boolean;
@@ -12,10 +237,11 @@ export class SoemMaster {
   configMapPDO(): void;
   state(): number;
   readState(): number;
-  sdoRead(slave: number, index: number, sub: number, ca?: boolean): Buffer | null;
+  sdoRead(slave: number, index: number, sub: number, ca?: boolean, maxSize?: number): Buffer | null;
+  sdoReadInto(slave: number, index: number, sub: number, target: ArrayBufferView, offset?: number, ca?: boolean): number;
   sdoWrite(slave: number, index: number, sub: number, data: Buffer, ca?: boolean): boolean;
   sendProcessdata(): number;
-  receiveProcessdata(): number;
+  receiveProcessdata(timeout?: number): number;
   close(): void;
   writeState(slave: number, state: number): number;
   stateCheck(slave: number, reqstate: number, timeout?: number): number;
@@ -24,13 +250,32 @@ export class SoemMaster {
   slaveMbxCyclic(slave: number): number;
   configDC(): boolean;
   getSlaves(): any[];
+  scanTopology(options?: TopologyScanOptions): TopologyScan | null;
+  configNewSlaves(group?: number): Promise<NewSlavesResult>;
+  slaveIdentity(slave: number): SlaveIdentity | null;
+  readObjectDictionary(slave: number, options?: ReadObjectDictionaryOptions): Promise<ObjectDictionary>;
+  static clearObjectDictionaryCache(): void;
   initRedundant(if1: string, if2: string): boolean;
+  redundancyStatus(): RedundancyStatus;
   configMapGroup(group?: number): Buffer | null;
   sendProcessdataGroup(group?: number): number;
   receiveProcessdataGroup(group?: number, timeout?: number): number;
+  exchange(outputs: ArrayBufferView | null, inputs: ArrayBufferView | null, status: Int32Array, group?: number, timeout?: number): void;
+  processImageLayout(group?: number): ProcessImageLayout | null;
   mbxHandler(group?: number, limit?: number): number;
-  elist2string(): string;
-  SoEread(slave: number, driveNo: number, elementflags: number, idn: number): Buffer | null;
+  configureMailbox(options: MailboxSchedulerOptions): void;
+  mailbox<R extends MailboxRequest>(request: R): Promise<MailboxResult<R>>;
+  mailboxStatus(): MailboxStatus;
+  startHistorian(options: HistorianOptions): boolean;
+  stopHistorian(): void;
+  historianStatus(): HistorianStatus;
+  static readHistory(dir: string, from?: bigint | number, to?: bigint | number, maxRecords?: number): Promise<HistoryRecords>;
+  elist2string(): string | null;
+  configureDiagnostics(options: DiagnosticsOptions): void;
+  drainDiagnostics(target: ArrayBufferView): number;
+  diagnosticsStatus(): DiagnosticsStatus;
+  SoEread(slave: number, driveNo: number, elementflags: number, idn: number, maxSize?: number): Buffer | null;
+  SoEreadInto(slave: number, driveNo: number, elementflags: number, idn: number, target: ArrayBufferView, offset?: number): number;
   SoEwrite(slave: number, driveNo: number, elementflags: number, idn: number, data: Buffer): boolean;
   readeeprom(slave: number, eeproma: number, timeout?: number): number;
   writeeeprom(slave: number, eeproma: number, data: number, timeout?: number): number;
@@ -43,3 +288,22 @@ export class SoemMaster {
   dcsync01(slave: number, act: boolean, CyclTime0: number, CyclTime1: number, CyclShift: number): boolean;
   static listInterfaces(): NetworkInterface[];
 }
+
+export class NodeSoemMaster {
+  constructor(ifname?: string, timeouts?: NodeSoemMasterTimeouts);
+  init(): number;
+  configInit(): number;
+  configMap(group?: number): number;
+  configDC(): number;
+  sendProcessdata(group?: number): number;
+  receiveProcessdata(timeout?: number, group?: number): number;
+  writeState(slave: number, state: number): number;
+  readState(): number;
+  statecheck(slave: number, state: number, timeout?: number): number;
+  getSlaves(): any[];
+  getInterfaceName(): string;
+  getMap(group?: number): ArrayBuffer;
+  getExpectedWC(group?: number): number;
+  setTimeouts(timeouts: NodeSoemMasterTimeouts): void;
+  close(): void;
+}